@@ -0,0 +1,83 @@
+//
+// Created by Tianjian Qin on 10/16/2026.
+// Class definition for the alias table, Walker's method for constant time sampling from a discrete distribution
+//
+
+#ifndef FUSION_ALIAS_TABLE_H
+#define FUSION_ALIAS_TABLE_H
+
+
+#include <vector>
+#include "random_service.h"
+
+class AliasTable {
+private:
+    std::vector<double> probabilities;           // Probability of keeping the column itself
+    std::vector<int> aliases;                    // Column taken otherwise
+    double totalWeight = 0.0;                    // Sum of the weights the table was built from
+    std::vector<double> scaled;                  // Scratch space of the build, kept to avoid reallocating on rebuilds
+    std::vector<int> small;
+    std::vector<int> large;
+
+public:
+    // Build the table from non-negative weights (Vose's variant)
+    void build(const std::vector<double>& weights) {
+        size_t n = weights.size();
+        probabilities.assign(n, 0.0);
+        aliases.assign(n, 0);
+        totalWeight = 0.0;
+        for (double weight : weights) {
+            totalWeight += weight;
+        }
+        if (totalWeight <= 0.0) {
+            return;
+        }
+
+        // Scale weights so that the average column holds exactly 1
+        scaled.resize(n);
+        small.clear();
+        large.clear();
+        for (size_t i = 0; i < n; ++i) {
+            scaled[i] = weights[i] * static_cast<double>(n) / totalWeight;
+            (scaled[i] < 1.0 ? small : large).push_back(static_cast<int>(i));
+        }
+
+        // Fill every small column up with a large one
+        while (!small.empty() && !large.empty()) {
+            int less = small.back();
+            small.pop_back();
+            int more = large.back();
+            probabilities[less] = scaled[less];
+            aliases[less] = more;
+            scaled[more] -= 1.0 - scaled[less];
+            if (scaled[more] < 1.0) {
+                large.pop_back();
+                small.push_back(more);
+            }
+        }
+
+        // Whatever is left is full up to rounding
+        for (int i : large) {
+            probabilities[i] = 1.0;
+            aliases[i] = i;
+        }
+        for (int i : small) {
+            probabilities[i] = 1.0;
+            aliases[i] = i;
+        }
+    }
+
+    // Sum of the weights the table was built from
+    [[nodiscard]] double getTotalWeight() const {
+        return totalWeight;
+    }
+
+    // Draw an index with probability proportional to its weight, the table must hold some positive weight
+    int sample(RandomStream& random) const {
+        size_t column = random.uniformIndex(probabilities.size());
+        return random.uniform() < probabilities[column] ? static_cast<int>(column) : aliases[column];
+    }
+};
+
+
+#endif //FUSION_ALIAS_TABLE_H
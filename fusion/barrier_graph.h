@@ -0,0 +1,223 @@
+//
+// Created by Tianjian Qin on 10/16/2026.
+// Class definition for the barrier graph, the symmetric barrier thresholds between isolations stored as a sparse
+// adjacency structure
+//
+
+#ifndef FUSION_BARRIER_GRAPH_H
+#define FUSION_BARRIER_GRAPH_H
+
+
+#include <algorithm>
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+#include "barrier_matrix.h"
+
+// Barrier thresholds between every pair of isolations, where a barrier of 1 (the default) means no exchange at all.
+// Large systems are mostly walled off, so only pairs below 1 are kept: rows of neighbours sorted by index, stored back
+// to back in one array (CSR) with some free room behind every row, so an update only moves the row it grows and
+// iterating over the neighbours of an isolation is a walk over one contiguous block. A row that outgrows its room moves
+// to the end of the array, and the array is compacted once more than half of it is left behind. Small systems keep a
+// dense barrier matrix instead, where lookups are a single load and row sums run over whole vectors.
+class BarrierGraph {
+public:
+    static constexpr size_t defaultDenseLimit = 1024;       // Largest number of isolations kept as a dense matrix (8 MiB)
+
+    // Neighbour of an isolation and the barrier between them
+    struct Edge {
+        int target;
+        double threshold;
+    };
+
+private:
+    size_t numIsolations;
+    bool dense;
+    BarrierMatrix matrix;                        // Dense: all thresholds, 1 on the diagonal
+    std::vector<Edge> edges;                     // Sparse: rows one after another, each followed by its free room
+    std::vector<size_t> rowStart;                // Sparse: offset of every row in the edge array
+    std::vector<size_t> rowSize;                 // Neighbours of every isolation (both layouts)
+    std::vector<size_t> rowCapacity;             // Sparse: room of every row
+    size_t abandoned = 0;                        // Sparse: entries of the edge array no row uses any more
+
+    // Position of a neighbour in a sparse row, or of the first neighbour after it
+    [[nodiscard]] size_t findInRow(int row, int target) const {
+        auto begin = edges.begin() + static_cast<std::ptrdiff_t>(rowStart[row]);
+        auto end = begin + static_cast<std::ptrdiff_t>(rowSize[row]);
+        auto position = std::lower_bound(begin, end, target, [](const Edge& edge, int t) { return edge.target < t; });
+        return static_cast<size_t>(position - edges.begin());
+    }
+
+    // Rewrite the edge array with every row in order and a little room behind each
+    void compact() {
+        std::vector<Edge> packed;
+        size_t total = 0;
+        for (size_t row = 0; row < numIsolations; ++row) {
+            total += rowSize[row] + rowSize[row] / 4 + 1;
+        }
+        packed.reserve(total);
+        for (size_t row = 0; row < numIsolations; ++row) {
+            size_t start = packed.size();
+            packed.insert(packed.end(), edges.begin() + static_cast<std::ptrdiff_t>(rowStart[row]),
+                          edges.begin() + static_cast<std::ptrdiff_t>(rowStart[row] + rowSize[row]));
+            rowStart[row] = start;
+            rowCapacity[row] = rowSize[row] + rowSize[row] / 4 + 1;
+            packed.resize(start + rowCapacity[row], Edge{-1, 1.0});
+        }
+        edges.swap(packed);
+        abandoned = 0;
+    }
+
+    // Move a full sparse row to the end of the edge array with twice the room
+    void grow(int row) {
+        size_t capacity = std::max<size_t>(4, rowCapacity[row] * 2);
+        size_t start = edges.size();
+        edges.resize(start + capacity, Edge{-1, 1.0});
+        std::copy_n(edges.begin() + static_cast<std::ptrdiff_t>(rowStart[row]), rowSize[row],
+                    edges.begin() + static_cast<std::ptrdiff_t>(start));
+        abandoned += rowCapacity[row];
+        rowStart[row] = start;
+        rowCapacity[row] = capacity;
+    }
+
+    // Set one direction of a sparse pair, thresholds of 1 or more remove the neighbour
+    void setDirected(int row, int target, double threshold) {
+        size_t position = findInRow(row, target);
+        size_t end = rowStart[row] + rowSize[row];
+        bool present = position < end && edges[position].target == target;
+
+        if (threshold >= 1.0) {
+            if (present) {
+                std::copy(edges.begin() + static_cast<std::ptrdiff_t>(position + 1),
+                          edges.begin() + static_cast<std::ptrdiff_t>(end),
+                          edges.begin() + static_cast<std::ptrdiff_t>(position));
+                --rowSize[row];
+            }
+            return;
+        }
+        if (present) {
+            edges[position].threshold = threshold;
+            return;
+        }
+
+        if (rowSize[row] == rowCapacity[row]) {
+            size_t offset = position - rowStart[row];
+            grow(row);
+            position = rowStart[row] + offset;
+            end = rowStart[row] + rowSize[row];
+        }
+        std::copy_backward(edges.begin() + static_cast<std::ptrdiff_t>(position),
+                           edges.begin() + static_cast<std::ptrdiff_t>(end),
+                           edges.begin() + static_cast<std::ptrdiff_t>(end + 1));
+        edges[position] = {target, threshold};
+        ++rowSize[row];
+    }
+
+public:
+    // Constructor, every barrier starts at 1. Systems up to denseLimit isolations use a dense matrix of the given layout.
+    explicit BarrierGraph(size_t isolations = 0, size_t denseLimit = defaultDenseLimit,
+                          BarrierMatrix::Layout denseLayout = BarrierMatrix::Layout::Full)
+            : numIsolations(isolations), dense(isolations <= denseLimit), rowSize(isolations, 0) {
+        if (dense) {
+            matrix = BarrierMatrix(numIsolations, denseLayout);
+        } else {
+            rowStart.assign(numIsolations, 0);
+            rowCapacity.assign(numIsolations, 0);
+        }
+    }
+
+    // Get the barrier between two isolations
+    [[nodiscard]] double get(int isolationA, int isolationB) const {
+        if (dense) {
+            return matrix.get(isolationA, isolationB);
+        }
+        size_t position = findInRow(isolationA, isolationB);
+        if (position < rowStart[isolationA] + rowSize[isolationA] && edges[position].target == isolationB) {
+            return edges[position].threshold;
+        }
+        return 1.0;
+    }
+
+    // Set the barrier between two different isolations in both directions
+    void set(int isolationA, int isolationB, double threshold) {
+        if (isolationA < 0 || isolationB < 0 || static_cast<size_t>(isolationA) >= numIsolations ||
+            static_cast<size_t>(isolationB) >= numIsolations) {
+            throw std::out_of_range("Isolation index is out of bounds");
+        }
+        if (isolationA == isolationB) {
+            return;
+        }
+        if (dense) {
+            int change = (threshold < 1.0) - (matrix.get(isolationA, isolationB) < 1.0);
+            rowSize[isolationA] += change;
+            rowSize[isolationB] += change;
+            matrix.set(isolationA, isolationB, threshold);
+            return;
+        }
+        setDirected(isolationA, isolationB, threshold);
+        setDirected(isolationB, isolationA, threshold);
+        if (abandoned > edges.size() / 2 && abandoned > 1024) {
+            compact();
+        }
+    }
+
+    // Call f(target, threshold) for every isolation behind a barrier below 1, in increasing order of the index
+    template <typename F>
+    void forEachNeighbor(int isolation, F&& f) const {
+        if (dense) {
+            matrix.forEachInRow(isolation, [&f](int target, double threshold) {
+                if (threshold < 1.0) {
+                    f(target, threshold);
+                }
+            });
+            return;
+        }
+        const Edge* row = edges.data() + rowStart[isolation];
+        for (size_t i = 0; i < rowSize[isolation]; ++i) {
+            f(row[i].target, row[i].threshold);
+        }
+    }
+
+    // Get the full row of an isolation, thresholds towards every isolation
+    [[nodiscard]] std::vector<double> getRow(int isolation) const {
+        std::vector<double> row(numIsolations, 1.0);
+        forEachNeighbor(isolation, [&row](int target, double threshold) { row[target] = threshold; });
+        return row;
+    }
+
+    // Get the sum of 1 - barrier over all other isolations, the rate of emigration per unit birth rate
+    [[nodiscard]] double getEmigrationWeight(int isolation) const {
+        if (dense) {
+            return matrix.emigrationWeight(isolation);
+        }
+        double sum = 0.0;
+        forEachNeighbor(isolation, [&sum](int, double threshold) { sum += 1.0 - threshold; });
+        return sum;
+    }
+
+    // Get the dense matrix, only meaningful for dense graphs
+    [[nodiscard]] const BarrierMatrix& getMatrix() const {
+        return matrix;
+    }
+
+    // Choose the instruction set of the dense row kernels, capped at what the CPU supports, sparse rows are always scalar
+    void setSimdLevel(SimdLevel level) {
+        matrix.setSimdLevel(level);
+    }
+
+    // Get the number of isolations behind a barrier below 1
+    [[nodiscard]] size_t getDegree(int isolation) const {
+        return rowSize[isolation];
+    }
+
+    [[nodiscard]] size_t size() const {
+        return numIsolations;
+    }
+
+    [[nodiscard]] bool isDense() const {
+        return dense;
+    }
+};
+
+
+#endif //FUSION_BARRIER_GRAPH_H
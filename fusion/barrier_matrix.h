@@ -0,0 +1,258 @@
+//
+// Created by Tianjian Qin on 10/16/2026.
+// Class definition for the barrier matrix, dense symmetric barrier thresholds in one aligned block
+//
+
+#ifndef FUSION_BARRIER_MATRIX_H
+#define FUSION_BARRIER_MATRIX_H
+
+
+#include <algorithm>
+#include <cstddef>
+#include <span>
+#include <stdexcept>
+#include <vector>
+#include "simd.h"
+
+// Barrier thresholds between every pair of isolations in one contiguous, cache-line aligned allocation. The full
+// layout pads every row to a whole number of cache lines and fills diagonal and padding with 1 (no exchange), so a row
+// is one aligned span whose emigration weights 1 - barrier and their sum can be computed over whole vectors without
+// any special cases. The packed layout keeps only the upper triangle, half the memory and one write per update, at the
+// price of rows that are only contiguous right of the diagonal.
+// The vector paths sum in a different order than the scalar one, so row sums agree to rounding only. The scalar level
+// is the default so seeded runs are bit-identical across machines; opt into a vector level where they need not be.
+class BarrierMatrix {
+public:
+    enum class Layout {
+        Full,
+        Packed
+    };
+
+private:
+    static constexpr size_t lineDoubles = 64 / sizeof(double);   // Doubles per cache line
+
+    size_t numIsolations = 0;
+    Layout layout = Layout::Full;
+    size_t stride = 0;                           // Full: doubles per padded row
+    std::vector<double, AlignedAllocator<double>> values;
+    SimdLevel level = SimdLevel::Scalar;         // Instruction set of the row kernels
+
+    // Position of the pair a < b in the packed upper triangle, rows of n - 1, n - 2, ... entries
+    [[nodiscard]] size_t packedIndex(size_t a, size_t b) const {
+        return a * (2 * numIsolations - a - 1) / 2 + (b - a - 1);
+    }
+
+    static double weightSumScalar(const double* row, size_t count) {
+        double sum = 0.0;
+        for (size_t j = 0; j < count; ++j) {
+            sum += 1.0 - row[j];
+        }
+        return sum;
+    }
+
+    static void weightsScalar(const double* row, size_t count, double* weights) {
+        for (size_t j = 0; j < count; ++j) {
+            weights[j] = 1.0 - row[j];
+        }
+    }
+
+#if FUSION_X86_SIMD
+    // Rows of the full layout are aligned and padded to whole cache lines, so these only ever see full vectors
+    __attribute__((target("avx2")))
+    static double weightSumAvx2(const double* row, size_t count) {
+        const __m256d one = _mm256_set1_pd(1.0);
+        __m256d low = _mm256_setzero_pd();
+        __m256d high = _mm256_setzero_pd();
+        for (size_t j = 0; j < count; j += 8) {
+            low = _mm256_add_pd(low, _mm256_sub_pd(one, _mm256_load_pd(row + j)));
+            high = _mm256_add_pd(high, _mm256_sub_pd(one, _mm256_load_pd(row + j + 4)));
+        }
+        alignas(32) double lanes[4];
+        _mm256_store_pd(lanes, _mm256_add_pd(low, high));
+        return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+    }
+
+    __attribute__((target("avx2")))
+    static void weightsAvx2(const double* row, size_t count, double* weights) {
+        const __m256d one = _mm256_set1_pd(1.0);
+        for (size_t j = 0; j < count; j += 4) {
+            _mm256_storeu_pd(weights + j, _mm256_sub_pd(one, _mm256_load_pd(row + j)));
+        }
+    }
+
+    __attribute__((target("avx512f")))
+    static double weightSumAvx512(const double* row, size_t count) {
+        const __m512d one = _mm512_set1_pd(1.0);
+        __m512d sum = _mm512_setzero_pd();
+        for (size_t j = 0; j < count; j += 8) {
+            sum = _mm512_add_pd(sum, _mm512_sub_pd(one, _mm512_load_pd(row + j)));
+        }
+        // Reduced by hand, _mm512_reduce_add_pd and _mm512_extractf64x4_pd trip -Wuninitialized in GCC 12
+        alignas(64) double lanes[8];
+        _mm512_store_pd(lanes, sum);
+        return ((lanes[0] + lanes[4]) + (lanes[1] + lanes[5])) + ((lanes[2] + lanes[6]) + (lanes[3] + lanes[7]));
+    }
+
+    __attribute__((target("avx512f")))
+    static void weightsAvx512(const double* row, size_t count, double* weights) {
+        const __m512d one = _mm512_set1_pd(1.0);
+        for (size_t j = 0; j < count; j += 8) {
+            _mm512_storeu_pd(weights + j, _mm512_sub_pd(one, _mm512_load_pd(row + j)));
+        }
+    }
+#endif
+
+public:
+    // Constructor, every barrier starts at 1
+    explicit BarrierMatrix(size_t isolations = 0, Layout matrixLayout = Layout::Full)
+            : numIsolations(isolations), layout(matrixLayout) {
+        if (layout == Layout::Full) {
+            stride = (numIsolations + lineDoubles - 1) / lineDoubles * lineDoubles;
+            values.assign(numIsolations * stride, 1.0);
+        } else {
+            values.assign(numIsolations * (numIsolations - std::min<size_t>(numIsolations, 1)) / 2, 1.0);
+        }
+    }
+
+    // Get the barrier between two isolations
+    [[nodiscard]] double get(int isolationA, int isolationB) const {
+        auto a = static_cast<size_t>(isolationA);
+        auto b = static_cast<size_t>(isolationB);
+        if (layout == Layout::Full) {
+            return values[a * stride + b];
+        }
+        if (a == b) {
+            return 1.0;
+        }
+        return values[a < b ? packedIndex(a, b) : packedIndex(b, a)];
+    }
+
+    // Set the barrier between two different isolations in both directions, the diagonal stays at 1
+    void set(int isolationA, int isolationB, double threshold) {
+        auto a = static_cast<size_t>(isolationA);
+        auto b = static_cast<size_t>(isolationB);
+        if (a == b) {
+            return;
+        }
+        if (layout == Layout::Full) {
+            values[a * stride + b] = threshold;
+            values[b * stride + a] = threshold;
+        } else {
+            values[a < b ? packedIndex(a, b) : packedIndex(b, a)] = threshold;
+        }
+    }
+
+    // Get the row of an isolation as an aligned span of numIsolations values, full layout only
+    [[nodiscard]] std::span<const double> row(int isolation) const {
+        if (layout != Layout::Full) {
+            throw std::logic_error("Packed barrier matrices have no contiguous rows");
+        }
+        return {values.data() + static_cast<size_t>(isolation) * stride, numIsolations};
+    }
+
+    // Get the part of a row right of the diagonal, contiguous in both layouts
+    [[nodiscard]] std::span<const double> upperRow(int isolation) const {
+        auto a = static_cast<size_t>(isolation);
+        if (layout == Layout::Full) {
+            return {values.data() + a * stride + a + 1, numIsolations - a - 1};
+        }
+        return {values.data() + (a + 1 < numIsolations ? packedIndex(a, a + 1) : 0), numIsolations - a - 1};
+    }
+
+    // Call f(target, threshold) for every other isolation, in increasing order of the index
+    template <typename F>
+    void forEachInRow(int isolation, F&& f) const {
+        auto a = static_cast<size_t>(isolation);
+        if (layout == Layout::Full) {
+            const double* entries = values.data() + a * stride;
+            for (size_t b = 0; b < numIsolations; ++b) {
+                if (b != a) {
+                    f(static_cast<int>(b), entries[b]);
+                }
+            }
+            return;
+        }
+        for (size_t b = 0; b < a; ++b) {
+            f(static_cast<int>(b), values[packedIndex(b, a)]);
+        }
+        std::span<const double> upper = upperRow(isolation);
+        for (size_t j = 0; j < upper.size(); ++j) {
+            f(static_cast<int>(a + 1 + j), upper[j]);
+        }
+    }
+
+    // Get the sum of 1 - barrier towards every other isolation, the rate of emigration per unit birth rate
+    [[nodiscard]] double emigrationWeight(int isolation) const {
+        if (layout == Layout::Packed) {
+            double sum = 0.0;
+            forEachInRow(isolation, [&sum](int, double threshold) { sum += 1.0 - threshold; });
+            return sum;
+        }
+        const double* entries = values.data() + static_cast<size_t>(isolation) * stride;
+        switch (level) {
+#if FUSION_X86_SIMD
+            case SimdLevel::AVX512:
+                return weightSumAvx512(entries, stride);
+            case SimdLevel::AVX2:
+                return weightSumAvx2(entries, stride);
+#endif
+            default:
+                return weightSumScalar(entries, numIsolations);
+        }
+    }
+
+    // Write 1 - barrier towards every isolation into a row of weights (0 for the isolation itself), which must hold
+    // getPaddedSize() values
+    void emigrationWeights(int isolation, std::span<double> weights) const {
+        if (layout == Layout::Packed) {
+            weights[isolation] = 0.0;
+            forEachInRow(isolation, [&weights](int target, double threshold) { weights[target] = 1.0 - threshold; });
+            return;
+        }
+        const double* entries = values.data() + static_cast<size_t>(isolation) * stride;
+        switch (level) {
+#if FUSION_X86_SIMD
+            case SimdLevel::AVX512:
+                weightsAvx512(entries, stride, weights.data());
+                break;
+            case SimdLevel::AVX2:
+                weightsAvx2(entries, stride, weights.data());
+                break;
+#endif
+            default:
+                weightsScalar(entries, numIsolations, weights.data());
+                break;
+        }
+    }
+
+    [[nodiscard]] SimdLevel getSimdLevel() const {
+        return level;
+    }
+
+    // Choose the instruction set of the row kernels, capped at what the CPU supports. Vector levels make row sums, and
+    // with them seeded runs, depend on the CPU.
+    void setSimdLevel(SimdLevel simdLevel) {
+        level = std::min(simdLevel, detectSimdLevel());
+    }
+
+    [[nodiscard]] size_t size() const {
+        return numIsolations;
+    }
+
+    // Get the number of values a row of weights has to hold, the row length rounded up to whole cache lines
+    [[nodiscard]] size_t getPaddedSize() const {
+        return layout == Layout::Full ? stride : numIsolations;
+    }
+
+    [[nodiscard]] Layout getLayout() const {
+        return layout;
+    }
+
+    // Get the memory held by the thresholds
+    [[nodiscard]] size_t getStorageBytes() const {
+        return values.size() * sizeof(double);
+    }
+};
+
+
+#endif //FUSION_BARRIER_MATRIX_H
@@ -0,0 +1,1228 @@
+//
+// Created by Tianjian Qin on 10/16/2026.
+// Benchmark program comparing the simulation engines
+//
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <new>
+#include <span>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "director.h"
+#include "ensemble.h"
+#include "event_file_reader.h"
+#include "compressed_event_file_reader.h"
+
+// Heap allocations made by the whole program, counted to check that stepping does not allocate
+static std::atomic<size_t> heapAllocations{0};
+
+// Every form of the global allocation functions is replaced, plain, array, over-aligned and non-throwing, so nothing
+// escapes the count and nothing is freed by an allocator it did not come from (sanitizers intercept the forms left
+// out). GCC sees the malloc inlined from operator new meet the free in operator delete at its call sites and reports
+// the pair as mismatched (-Wmismatched-new-delete), although both sides are replaced together.
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+
+void* operator new(std::size_t size) {
+    heapAllocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* pointer = std::malloc(size > 0 ? size : 1)) {
+        return pointer;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment) {
+    heapAllocations.fetch_add(1, std::memory_order_relaxed);
+    auto align = static_cast<std::size_t>(alignment);
+    if (void* pointer = std::aligned_alloc(align, (std::max<std::size_t>(size, 1) + align - 1) / align * align)) {
+        return pointer;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size) {
+    return ::operator new(size);
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment) {
+    return ::operator new(size, alignment);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    try {
+        return ::operator new(size);
+    } catch (const std::bad_alloc&) {
+        return nullptr;
+    }
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    try {
+        return ::operator new(size, alignment);
+    } catch (const std::bad_alloc&) {
+        return nullptr;
+    }
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    return ::operator new(size, std::nothrow);
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return ::operator new(size, alignment, std::nothrow);
+}
+
+void operator delete(void* pointer) noexcept {
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, std::size_t) noexcept {
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, std::align_val_t) noexcept {
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, std::size_t, std::align_val_t) noexcept {
+    std::free(pointer);
+}
+
+void operator delete[](void* pointer) noexcept {
+    std::free(pointer);
+}
+
+void operator delete[](void* pointer, std::size_t) noexcept {
+    std::free(pointer);
+}
+
+void operator delete[](void* pointer, std::align_val_t) noexcept {
+    std::free(pointer);
+}
+
+void operator delete[](void* pointer, std::size_t, std::align_val_t) noexcept {
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, const std::nothrow_t&) noexcept {
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, std::align_val_t, const std::nothrow_t&) noexcept {
+    std::free(pointer);
+}
+
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept {
+    std::free(pointer);
+}
+
+void operator delete[](void* pointer, std::align_val_t, const std::nothrow_t&) noexcept {
+    std::free(pointer);
+}
+
+#pragma GCC diagnostic pop
+
+// Name of a sampling method for reporting
+static std::string methodName(SamplingMethod method) {
+    switch (method) {
+        case SamplingMethod::Direct:
+            return "Direct";
+        case SamplingMethod::SumTree:
+            return "SumTree";
+        case SamplingMethod::CompositionRejection:
+            return "CompositionRejection";
+        case SamplingMethod::NextReaction:
+            return "NextReaction";
+        case SamplingMethod::Hierarchical:
+            return "Hierarchical";
+    }
+    return "Unknown";
+}
+
+// Rates spread log-uniformly over several orders of magnitude, like barrier-scaled immigration next to births
+static double wideRangeRate(RandomStream& random) {
+    return std::pow(10.0, -3.0 + 6.0 * random.uniform());
+}
+
+// Time sampling plus the incremental updates a fired event causes (one rate change, one entry added and removed)
+static void benchmarkSelector(SamplingMethod method, size_t numEvents, size_t numIsolations, size_t numSteps) {
+    RandomService service(42);
+    RandomStream random = service.stream(SelectionStream);
+    auto selector = Director::makeSelector(method, service.stream(FiringTimeStream));
+    for (size_t i = 0; i < numEvents; ++i) {
+        selector->add(wideRangeRate(random), static_cast<int>(i % numIsolations));
+    }
+
+    size_t checksum = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t step = 0; step < numSteps; ++step) {
+        auto [waitingTime, index] = selector->sampleNext(random);
+        checksum += index;
+        selector->update(index, wideRangeRate(random));
+        selector->add(wideRangeRate(random), static_cast<int>(index % numIsolations));
+        selector->remove(index);
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    double nanoseconds = std::chrono::duration<double, std::nano>(end - start).count() / static_cast<double>(numSteps);
+    std::cout << methodName(method) << " | events: " << numEvents << " | isolations: " << numIsolations
+              << " | " << nanoseconds << " ns/step"
+              << " | checksum: " << checksum << "\n";
+}
+
+// Time the exact simulation loop end to end: selection, dispatch, execution, logging and rate updates
+static void benchmarkSimulation(SamplingMethod method, int numIsolations, double maxTime, bool nicheCompetition = false) {
+    bool wasVerbose = System::isVerbose();
+    System::setVerbose(false);
+    size_t events = 0;
+    size_t logBytes = 0;
+    auto start = std::chrono::steady_clock::now();
+    {
+        Director director(numIsolations, 0.5, 0.2, method, 42);
+        director.setNicheCompetition(nicheCompetition);
+        director.simulate(maxTime);
+        events = director.getObserver().getEventHistory().size();
+        logBytes = director.getObserver().getEventHistory().getMemoryBytes();
+    }
+    auto end = std::chrono::steady_clock::now();
+    System::setVerbose(wasVerbose);
+
+    double nanoseconds = std::chrono::duration<double, std::nano>(end - start).count() / static_cast<double>(std::max<size_t>(events, 1));
+    std::cout << methodName(method) << (nicheCompetition ? " + niche competition" : "") << " | isolations: "
+              << numIsolations << " | events: " << events
+              << " | " << nanoseconds << " ns/event"
+              << " | log: " << static_cast<double>(logBytes) / static_cast<double>(std::max<size_t>(events, 1))
+              << " B/event\n";
+}
+
+// Time the exact simulation loop with the event history kept in memory or streamed to a file
+static void benchmarkEventSink(const std::string& name, const EventStreamSettings* streamSettings, double maxTime) {
+    bool wasVerbose = System::isVerbose();
+    System::setVerbose(false);
+    std::string path = (std::filesystem::temp_directory_path() / "fusion_benchmark_events.bin").string();
+    EventStreamStatistics statistics;
+    size_t events = 0;
+    size_t bytes = 0;
+    auto start = std::chrono::steady_clock::now();
+    {
+        Director director(3, 0.5, 0.2, SamplingMethod::SumTree, 42);
+        if (streamSettings) {
+            director.streamEvents(path, *streamSettings);
+        }
+        director.simulate(maxTime);
+        statistics = director.closeEventStream();
+        events = streamSettings ? statistics.logged : director.getObserver().getEventHistory().size();
+        bytes = streamSettings ? EventStreamWriter::getBufferBytes(*streamSettings)
+                               : director.getObserver().getEventHistory().getMemoryBytes();
+    }
+    auto end = std::chrono::steady_clock::now();
+    System::setVerbose(wasVerbose);
+
+    std::filesystem::remove(path);
+    double nanoseconds = std::chrono::duration<double, std::nano>(end - start).count() / static_cast<double>(std::max<size_t>(events, 1));
+    std::cout << name << " | events: " << events << " | " << nanoseconds << " ns/event | memory: "
+              << static_cast<double>(bytes) / (1024.0 * 1024.0) << " MiB";
+    if (streamSettings) {
+        std::cout << " | written: " << statistics.written << " | dropped: " << statistics.dropped
+                  << " | sampled out: " << statistics.sampledOut << " | writes: " << statistics.writes;
+    }
+    std::cout << "\n";
+}
+
+// Silences System for a scope and restores the previous setting however the scope is left
+class QuietSystem {
+private:
+    bool wasVerbose = System::isVerbose();
+
+public:
+    QuietSystem() {
+        System::setVerbose(false);
+    }
+
+    ~QuietSystem() {
+        System::setVerbose(wasVerbose);
+    }
+
+    QuietSystem(const QuietSystem&) = delete;
+    QuietSystem& operator=(const QuietSystem&) = delete;
+};
+
+// Run a check with System silenced and print one line for it: the name, the details the check writes (as " | key:
+// value" fields), then whether it passed. A check that throws fails, with the exception in its line.
+template <typename Check>
+static bool runCheck(const std::string& name, Check&& check) {
+    std::ostringstream details;
+    bool passed;
+    try {
+        QuietSystem quiet;
+        passed = check(details);
+    } catch (const std::exception& exception) {
+        passed = false;
+        details << " | threw: " << exception.what();
+    }
+    std::cout << name << details.str() << " | " << (passed ? "passed" : "FAILED") << "\n";
+    return passed;
+}
+
+// Whether two records are equal field by field, times bit for bit
+static bool sameRecord(const EventRecord& a, const EventRecord& b) {
+    return std::memcmp(&a.time, &b.time, sizeof(double)) == 0 && a.type == b.type && a.population == b.population &&
+           a.parent == b.parent && a.source == b.source && a.target == b.target && a.property == b.property &&
+           std::memcmp(&a.oldValue, &b.oldValue, sizeof(double)) == 0 &&
+           std::memcmp(&a.newValue, &b.newValue, sizeof(double)) == 0;
+}
+
+// Number of positions at which two lists of records differ, every missing or extra record counting as one
+static size_t countMismatches(const std::vector<EventRecord>& records, const std::vector<EventRecord>& expected) {
+    size_t mismatches = std::max(records.size(), expected.size()) - std::min(records.size(), expected.size());
+    for (size_t i = 0; i < std::min(records.size(), expected.size()); ++i) {
+        mismatches += !sameRecord(records[i], expected[i]);
+    }
+    return mismatches;
+}
+
+// Records of every type as the observer logs them (unused fields -1 or 0, deaths without island), with runs of equal
+// times, or times in no order at all
+static std::vector<EventRecord> makeCheckRecords(size_t count, bool timeOrdered) {
+    RandomStream random = RandomService(7).stream(SelectionStream);
+    std::vector<EventRecord> records;
+    double time = 0.0;
+    PopulationId nextId = 0;
+    for (size_t i = 0; i < count; ++i) {
+        time = timeOrdered ? time + (random.uniform() < 0.3 ? 0.0 : 0.01 * random.uniform()) : 10.0 * random.uniform();
+        PopulationId population = nextId > 0 ? static_cast<PopulationId>(random.uniformIndex(nextId)) : 0;
+        PopulationId parent = nextId > 0 ? population : -1;    // The first population has no parent in the file
+        auto island = static_cast<int64_t>(random.uniformIndex(5));
+        switch (random.uniformIndex(4)) {
+            case 0:
+                records.push_back({EventType::Birth, time, nextId++, parent, island, -1, -1, 0.0, 0.0});
+                break;
+            case 1:
+                records.push_back({EventType::Death, time, population, -1, -1, -1, -1, 0.0, 0.0});
+                break;
+            case 2:
+                records.push_back({EventType::Immigration, time, nextId++, parent, island,
+                                   static_cast<int64_t>(random.uniformIndex(5)), -1, 0.0, 0.0});
+                break;
+            default:
+                records.push_back({EventType::Mutation, time, population, -1, island, -1,
+                                   static_cast<int64_t>(random.uniformIndex(2)), random.uniform(), -random.uniform()});
+                break;
+        }
+    }
+    return records;
+}
+
+// Check that the event log gives back what was appended, across block and chunk boundaries, after rollbacks that cut
+// into earlier blocks and chunks (also within runs of equal times), and when merged from logs split by island
+static bool checkEventLog(std::ostream& details) {
+    const char* const propertyNames[] = {"mobility", "mutation rate"};
+    auto append = [&propertyNames](EventLog& log, const EventRecord& record) {
+        switch (record.type) {
+            case EventType::Birth:
+                log.appendBirth(record.time, record.parent, record.population, static_cast<int>(record.source));
+                break;
+            case EventType::Death:
+                log.appendDeath(record.time, record.population);
+                break;
+            case EventType::Immigration:
+                log.appendImmigration(record.time, record.parent, record.population, static_cast<int>(record.source),
+                                      static_cast<int>(record.target));
+                break;
+            case EventType::Mutation:
+                log.appendMutation(record.time, record.population, static_cast<int>(record.source),
+                                   propertyNames[record.property], record.oldValue, record.newValue);
+                break;
+        }
+    };
+    // The log numbers properties in the order it first sees them, translate back to the indices of the records
+    auto readBack = [&propertyNames](const EventLog& log) {
+        std::vector<EventRecord> read;
+        log.forEach([&](EventRecord record) {
+            if (record.type == EventType::Mutation) {
+                record.property = std::strcmp(log.getPropertyName(record.property), propertyNames[0]) == 0 ? 0 : 1;
+            }
+            read.push_back(record);
+        });
+        return read;
+    };
+
+    RandomStream random = RandomService(19).stream(SelectionStream);
+    std::vector<EventRecord> records = makeCheckRecords(50000, true);
+    EventLog log;
+    std::vector<EventRecord> expected;
+    size_t mismatches = 0;
+    size_t rollbacks = 0;
+    for (const EventRecord& record : records) {
+        append(log, record);
+        expected.push_back(record);
+        if (random.uniform() < 0.001) {
+            size_t back = random.uniformIndex(std::min<size_t>(expected.size(), 5000));
+            double cut = expected[expected.size() - 1 - back].time;
+            log.discardAfter(cut);
+            while (!expected.empty() && expected.back().time > cut) {
+                expected.pop_back();
+            }
+            mismatches += countMismatches(readBack(log), expected);
+            ++rollbacks;
+        }
+    }
+    mismatches += countMismatches(readBack(log), expected);
+    log.discardAfter(-1.0);
+    mismatches += log.size() != 0;
+
+    // Merged logs keep the order of the logs and within them for equal times, as a stable sort of the logs in a row
+    std::vector<EventLog> islands(3);
+    std::vector<EventRecord> concatenated;
+    for (size_t island = 0; island < islands.size(); ++island) {
+        for (const EventRecord& record : records) {
+            if (std::max<int64_t>(record.source, 0) % 3 == static_cast<int64_t>(island)) {
+                append(islands[island], record);
+                concatenated.push_back(record);
+            }
+        }
+    }
+    std::stable_sort(concatenated.begin(), concatenated.end(),
+                     [](const EventRecord& a, const EventRecord& b) { return a.time < b.time; });
+    mismatches += countMismatches(readBack(EventLog::merge({&islands[0], &islands[1], &islands[2]})), concatenated);
+
+    details << " | events: " << records.size() << " | rollbacks: " << rollbacks << " | mismatches: " << mismatches;
+    return mismatches == 0 && rollbacks > 0;
+}
+
+// Follow the records creating a population and its ancestors by scanning all records
+static std::vector<EventRecord> scanLineage(const std::vector<EventRecord>& records, PopulationId id) {
+    std::vector<EventRecord> lineage;
+    auto creates = [&id](const EventRecord& record) {
+        return (record.type == EventType::Birth || record.type == EventType::Immigration) && record.population == id;
+    };
+    while (id >= 0) {
+        auto creation = std::find_if(records.begin(), records.end(), creates);
+        if (creation == records.end()) {
+            break;
+        }
+        lineage.push_back(*creation);
+        id = creation->parent;
+    }
+    return lineage;
+}
+
+// Check that an indexed event file gives back what was written, by position and through the time range, population
+// and lineage queries its block index and filters prune, for files that are empty, end in a partial block or are out
+// of time order, and that files with a malformed filter size are rejected
+static bool checkEventFile(std::ostream& details) {
+    std::string path = (std::filesystem::temp_directory_path() / "fusion_check_events.bin").string();
+    const std::vector<std::string> propertyNames = {"mobility", "mutation rate"};
+    size_t mismatches = 0;
+    size_t files = 0;
+    for (auto [count, timeOrdered] : {std::pair<size_t, bool>{0, true}, {1, true}, {1000, true}, {1000, false}}) {
+        std::vector<EventRecord> records = makeCheckRecords(count, timeOrdered);
+        {
+            EventFileWriter writer(path, 64);    // 1000 records leave a partial last block
+            for (const EventRecord& record : records) {
+                writer.append(record);
+            }
+            writer.close(propertyNames);
+        }
+        EventFileReader reader(path);
+        ++files;
+        std::vector<EventRecord> read;
+        for (size_t i = 0; i < reader.size(); ++i) {
+            read.push_back(reader.getRecord(i));
+        }
+        mismatches += countMismatches(read, records) + (reader.getPropertyName(1) != propertyNames[1]);
+
+        for (auto [from, to] : {std::pair<double, double>{-1.0, 100.0}, {2.0, 2.5}, {3.0, 3.0}, {50.0, 60.0}}) {
+            std::vector<EventRecord> expected;
+            std::copy_if(records.begin(), records.end(), std::back_inserter(expected),
+                         [from, to](const EventRecord& record) { return record.time >= from && record.time <= to; });
+            mismatches += countMismatches(reader.getEventsBetween(from, to), expected);
+        }
+        for (PopulationId id : {PopulationId(0), PopulationId(17), PopulationId(123456)}) {
+            std::vector<EventRecord> expected;
+            std::copy_if(records.begin(), records.end(), std::back_inserter(expected),
+                         [id](const EventRecord& record) { return record.population == id || record.parent == id; });
+            mismatches += countMismatches(reader.getEventsOfPopulation(id), expected);
+        }
+        for (const EventRecord& record : records) {
+            if (record.type == EventType::Birth || record.type == EventType::Immigration) {
+                mismatches += countMismatches(reader.getLineage(record.population),
+                                              scanLineage(records, record.population));
+            }
+        }
+    }
+
+    // A zero or non-power-of-two filter size would send filter lookups outside the blocks
+    size_t rejected = 0;
+    for (uint32_t filterBytes : {0u, 48u}) {
+        EventFileHeader header{};
+        {
+            std::ifstream in(path, std::ios::binary);
+            in.read(reinterpret_cast<char*>(&header), sizeof(header));
+        }
+        header.filterBytes = filterBytes;
+        {
+            std::fstream out(path, std::ios::binary | std::ios::in | std::ios::out);
+            out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        }
+        try {
+            EventFileReader reader(path);
+        } catch (const std::runtime_error&) {
+            ++rejected;
+        }
+    }
+    std::filesystem::remove(path);
+
+    details << " | files: " << files << " | mismatches: " << mismatches << " | malformed filters rejected: " << rejected
+            << " of 2";
+    return mismatches == 0 && rejected == 2;
+}
+
+// Check that a compressed event file decodes to what was encoded, with either time encoding, on one thread or several
+// and through the time range and population queries, for files that are empty, end in a partial block, carry the -1
+// of unused fields or are out of time order
+static bool checkCompressedEventFile(std::ostream& details) {
+    std::string path = (std::filesystem::temp_directory_path() / "fusion_check_events.cz").string();
+    const std::vector<std::string> propertyNames = {"mobility", "mutation rate"};
+    size_t mismatches = 0;
+    size_t files = 0;
+    for (TimeEncoding encoding : {TimeEncoding::Delta, TimeEncoding::Xor}) {
+        for (auto [count, timeOrdered] : {std::pair<size_t, bool>{0, true}, {1, true}, {1000, true}, {1000, false}}) {
+            std::vector<EventRecord> records = makeCheckRecords(count, timeOrdered);
+            {
+                CompressedEventFileWriter writer(path, 64, encoding);    // 1000 records leave a partial last block
+                for (const EventRecord& record : records) {
+                    writer.append(record);
+                }
+                writer.close(propertyNames);
+            }
+            CompressedEventFileReader reader(path);
+            ++files;
+            mismatches += countMismatches(reader.readAll(1), records) + countMismatches(reader.readAll(4), records) +
+                          (reader.getTimeEncoding() != encoding) + (reader.getPropertyName(1) != propertyNames[1]);
+
+            for (auto [from, to] : {std::pair<double, double>{-1.0, 100.0}, {2.0, 2.5}, {3.0, 3.0}, {50.0, 60.0}}) {
+                std::vector<EventRecord> expected;
+                std::copy_if(records.begin(), records.end(), std::back_inserter(expected),
+                             [from, to](const EventRecord& record) { return record.time >= from && record.time <= to; });
+                mismatches += countMismatches(reader.getEventsBetween(from, to), expected);
+            }
+            for (PopulationId id : {PopulationId(0), PopulationId(17), PopulationId(123456)}) {
+                std::vector<EventRecord> expected;
+                std::copy_if(records.begin(), records.end(), std::back_inserter(expected),
+                             [id](const EventRecord& record) { return record.population == id || record.parent == id; });
+                mismatches += countMismatches(reader.getEventsOfPopulation(id), expected);
+            }
+            mismatches += reader.getEventsOfPopulation(-1).size();
+        }
+    }
+    std::filesystem::remove(path);
+
+    details << " | files: " << files << " | mismatches: " << mismatches;
+    return mismatches == 0;
+}
+
+// Time queries on an event file against reading all of it
+static void benchmarkEventFile(double maxTime) {
+    bool wasVerbose = System::isVerbose();
+    System::setVerbose(false);
+    std::string path = (std::filesystem::temp_directory_path() / "fusion_benchmark_events.bin").string();
+    {
+        Director director(3, 0.5, 0.2, SamplingMethod::SumTree, 42);
+        director.simulate(maxTime);
+        director.getObserver().writeEventLog(path);
+    }
+    System::setVerbose(wasVerbose);
+
+    {
+        EventFileReader reader(path);
+        PopulationId population = reader.getRecord(reader.size() / 2).population;
+        auto time = [](auto&& query) {
+            auto start = std::chrono::steady_clock::now();
+            size_t result = query();
+            auto end = std::chrono::steady_clock::now();
+            return std::make_pair(std::chrono::duration<double, std::micro>(end - start).count(), result);
+        };
+        auto [scanMicroseconds, scanned] = time([&]() {
+            size_t count = 0;
+            reader.forEachInTimeRange(-std::numeric_limits<double>::infinity(), std::numeric_limits<double>::infinity(),
+                                      [&count](const EventRecord&) { ++count; });
+            return count;
+        });
+        double from = maxTime / 2;
+        size_t rangeBlocks = 0;
+        size_t populationBlocks = 0;
+        auto [rangeMicroseconds, inRange] = time([&]() {
+            size_t count = 0;
+            rangeBlocks = reader.forEachInTimeRange(from, from + 0.25, [&count](const EventRecord&) { ++count; });
+            return count;
+        });
+        auto [populationMicroseconds, ofPopulation] = time([&]() {
+            size_t count = 0;
+            populationBlocks = reader.forEachOfPopulation(population, [&count](const EventRecord&) { ++count; });
+            return count;
+        });
+        auto [lineageMicroseconds, lineageLength] = time([&]() { return reader.getLineage(population).size(); });
+
+        std::cout << "Event file | records: " << reader.size() << " | blocks: " << reader.getNumberOfBlocks()
+                  << " | full scan: " << scanMicroseconds << " us (" << scanned << " records)"
+                  << " | time range: " << rangeMicroseconds << " us (" << inRange << " records, " << rangeBlocks
+                  << " blocks)"
+                  << " | population: " << populationMicroseconds << " us (" << ofPopulation << " records, "
+                  << populationBlocks << " blocks)"
+                  << " | lineage: " << lineageMicroseconds << " us (" << lineageLength << " generations)\n";
+    }
+    std::filesystem::remove(path);
+}
+
+// Compare the size of a history as an indexed and as a compressed event file, and time decoding all of it
+static void benchmarkCompressedEventFile(double maxTime) {
+    bool wasVerbose = System::isVerbose();
+    System::setVerbose(false);
+    std::string indexedPath = (std::filesystem::temp_directory_path() / "fusion_benchmark_events.bin").string();
+    std::string compressedPath = (std::filesystem::temp_directory_path() / "fusion_benchmark_events.cz").string();
+    Director director(3, 0.5, 0.2, SamplingMethod::SumTree, 42);
+    director.simulate(maxTime);
+    System::setVerbose(wasVerbose);
+    const EventLog& history = director.getObserver().getEventHistory();
+    std::vector<EventRecord> expected;
+    history.forEach([&expected](const EventRecord& record) { expected.push_back(record); });
+    director.getObserver().writeEventLog(indexedPath);
+    auto indexedBytes = static_cast<double>(std::filesystem::file_size(indexedPath));
+    std::filesystem::remove(indexedPath);
+
+    for (TimeEncoding encoding : {TimeEncoding::Delta, TimeEncoding::Xor}) {
+        auto start = std::chrono::steady_clock::now();
+        director.getObserver().writeCompressedEventLog(compressedPath, encoding);
+        auto end = std::chrono::steady_clock::now();
+        double writeMilliseconds = std::chrono::duration<double, std::milli>(end - start).count();
+
+        CompressedEventFileReader reader(compressedPath);
+        std::cout << "Compressed event file, " << (encoding == TimeEncoding::Delta ? "delta" : "XOR")
+                  << " times | records: " << reader.size() << " | "
+                  << static_cast<double>(reader.getFileBytes()) / static_cast<double>(std::max<size_t>(reader.size(), 1))
+                  << " B/record (" << indexedBytes / static_cast<double>(reader.getFileBytes())
+                  << "x smaller than indexed) | write: " << writeMilliseconds << " ms";
+        for (size_t numThreads : {1, 4}) {
+            start = std::chrono::steady_clock::now();
+            std::vector<EventRecord> records = reader.readAll(numThreads);
+            end = std::chrono::steady_clock::now();
+            size_t mismatches = countMismatches(records, expected);
+            std::cout << " | decode on " << numThreads << " thread" << (numThreads > 1 ? "s" : "") << ": "
+                      << std::chrono::duration<double, std::milli>(end - start).count() << " ms (" << mismatches
+                      << " mismatches)";
+        }
+        std::cout << "\n";
+        std::filesystem::remove(compressedPath);
+    }
+}
+
+// Check that exact steps do not touch the heap once the simulation has warmed up and room is reserved for the steps
+// to come: at most one new population and two logged events (a birth and its mutation) per step
+static bool checkStepAllocations(std::ostream& details, SamplingMethod method, size_t warmupSteps,
+                                 size_t measuredSteps) {
+    Director director(3, 0.5, 0.2, method, 7); // A seed under which no method's run goes extinct early
+    director.computeEventRates();
+    double currentTime = 0.0;
+    double maxTime = std::numeric_limits<double>::infinity();
+    for (size_t step = 0; step < warmupSteps; ++step) {
+        currentTime = director.stepExact(currentTime, maxTime);
+    }
+
+    size_t numPopulations = 0;
+    for (const auto& isolation : director.getSystem().getAllIsolations()) {
+        numPopulations += isolation->getUnitPopulations().size();
+    }
+    director.reserve(numPopulations + measuredSteps,
+                     director.getObserver().getEventHistory().size() + 2 * measuredSteps);
+
+    size_t before = heapAllocations.load(std::memory_order_relaxed);
+    for (size_t step = 0; step < measuredSteps; ++step) {
+        currentTime = director.stepExact(currentTime, maxTime);
+    }
+    size_t allocations = heapAllocations.load(std::memory_order_relaxed) - before;
+
+    details << " | " << methodName(method) << " | populations: " << numPopulations << " | steps: " << measuredSteps
+            << " | heap allocations: " << allocations;
+    return allocations == 0;
+}
+
+// Time deaths by id followed by births on an island of a fixed size, the churn of a death-heavy regime
+static void benchmarkPopulationChurn(size_t numPopulations, size_t numSteps) {
+    RandomStream random = RandomService(42).stream(SelectionStream);
+    size_t numNiches = nicheDimensions == dynamicNiches ? 3 : nicheDimensions;
+    Isolation isolation(0, NicheSpaces(std::vector<std::pair<double, double>>(numNiches, {0.0, 10.0})));
+    std::vector<double> resources(numNiches, 1.0);
+    std::vector<PopulationId> alive;
+    PopulationId nextId = 0;
+    for (; nextId < static_cast<PopulationId>(numPopulations); ++nextId) {
+        isolation.addUnitPopulation(UnitPopulation(nextId, 0, std::nullopt, 0.01, 0.1, resources, 0.5));
+        alive.push_back(nextId);
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    for (size_t step = 0; step < numSteps; ++step) {
+        size_t victim = random.uniformIndex(alive.size());
+        isolation.removeUnitPopulation(alive[victim]);
+        PopulationStore& populations = isolation.getPopulationStore();
+        populations.addClone(populations, random.uniformIndex(populations.size()), nextId, 0);
+        alive[victim] = nextId++;
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    double nanoseconds = std::chrono::duration<double, std::nano>(end - start).count() / static_cast<double>(numSteps);
+    std::cout << "Churn | populations: " << numPopulations << " | " << nanoseconds << " ns per death and birth\n";
+}
+
+// Time one niche competition pass over an island's populations at every instruction set the machine supports
+static void benchmarkNicheKernel(size_t numPopulations, size_t numNiches) {
+    RandomStream random = RandomService(42).stream(SelectionStream);
+    std::vector<double> resourceUse(numPopulations * numNiches);
+    for (double& use : resourceUse) {
+        use = random.uniform();
+    }
+    std::vector<double> availableSpace(numNiches, 10.0 * static_cast<double>(numPopulations));
+    std::vector<double> occupiedSpace(numNiches);
+    std::vector<double> birthRates(numPopulations);
+    std::vector<double> deathRates(numPopulations);
+
+    NicheCompetitionKernel kernel;
+    SimdLevel detected = detectSimdLevel();
+    for (SimdLevel level : {SimdLevel::Scalar, SimdLevel::AVX2, SimdLevel::AVX512}) {
+        if (level > detected) {
+            break;
+        }
+        kernel.setSimdLevel(level);
+        size_t repetitions = std::max<size_t>(1, 10000000 / numPopulations);
+        double checksum = 0.0;
+        auto start = std::chrono::steady_clock::now();
+        for (size_t repetition = 0; repetition < repetitions; ++repetition) {
+            kernel.run(resourceUse, numPopulations, numNiches, availableSpace, 0.5, 0.2, occupiedSpace, birthRates, deathRates);
+            checksum += birthRates[repetition % numPopulations];
+        }
+        auto end = std::chrono::steady_clock::now();
+
+        double nanoseconds = std::chrono::duration<double, std::nano>(end - start).count() /
+                             static_cast<double>(repetitions * numPopulations);
+        std::cout << simdLevelName(level) << " | populations: " << numPopulations << " | niches: " << numNiches
+                  << " | " << nanoseconds << " ns/population | checksum: " << checksum << "\n";
+    }
+}
+
+// Check that every niche axis the simulation is compiled for enters occupancy and rates: the initial population uses
+// all of them, resource changes target all of them, and squeezing the last axis alone lowers the birth rate
+static bool checkNicheDimensions(std::ostream& details) {
+    System system(1, 0.5, 0.2);
+    EventRateStore rateStore(system, 0.5, 0.2, std::make_unique<DirectSelector>());
+    rateStore.rebuild();
+
+    const Isolation& isolation = *system.getIsolation(0);
+    const PopulationStore& populations = isolation.getUnitPopulations();
+    size_t numNiches = isolation.getNicheSpaces().getNumberOfDimensions();
+    std::span<const double> available = isolation.getNicheSpaces().getAvailableSpaces();
+    std::vector<double> squeezed(available.begin(), available.end());
+    squeezed.back() = 0.5;
+
+    NicheCompetitionKernel kernel;
+    std::vector<double> occupied(numNiches);
+    std::vector<double> ampleBirths(populations.size());
+    std::vector<double> squeezedBirths(populations.size());
+    std::vector<double> deaths(populations.size());
+    kernel.run(populations.getResourceUse(), populations.size(), numNiches, available, 0.5, 0.2, occupied,
+               ampleBirths, deaths);
+    kernel.run(populations.getResourceUse(), populations.size(), numNiches, squeezed, 0.5, 0.2, occupied,
+               squeezedBirths, deaths);
+
+    details << " | axes: " << numNiches << " | occupancy of the last axis: " << occupied.back()
+            << " | birth rate with the last axis squeezed: " << ampleBirths[0] << " -> " << squeezedBirths[0];
+    return populations.getNumberOfNiches() == numNiches && rateStore.getResourceTarget(0).size() == numNiches &&
+           occupied.back() == 1.0 && squeezedBirths[0] < ampleBirths[0];
+}
+
+// Check that barrier changes in a system large enough for a sparse barrier graph only retune its edges: after many of
+// them a ring of islands still has two neighbours per island
+static bool checkSparseBarrierChanges(std::ostream& details, int numIsolations, size_t numChanges) {
+    System system(numIsolations, 0.5, 0.2);
+    for (int island = 0; island < numIsolations; ++island) {
+        system.setBarrierThreshold(island, (island + 1) % numIsolations, 0.8);
+    }
+    RandomStream random = RandomService(42).stream(SelectionStream);
+    auto start = std::chrono::steady_clock::now();
+    for (size_t change = 0; change < numChanges; ++change) {
+        int island = static_cast<int>(random.uniformIndex(static_cast<size_t>(numIsolations)));
+        BarrierThresholdChangeEvent event(system.getIsolation(island), system, EventRateStore::barrierTarget);
+        event.execute();
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    size_t edges = 0;
+    for (int island = 0; island < numIsolations; ++island) {
+        edges += system.getBarrierThresholds().getDegree(island);
+    }
+    details << " | isolations: " << numIsolations << " | changes: " << numChanges << " | edges after: " << edges << " | "
+            << std::chrono::duration<double, std::nano>(end - start).count() / static_cast<double>(numChanges)
+            << " ns/change";
+    return !system.getBarrierThresholds().isDense() && edges == 2 * static_cast<size_t>(numIsolations);
+}
+
+// Check that an island rolled back to a state saved between two messages of the same time still applies the second:
+// an island that took every message up front and one that is rolled back into that state must end up the same
+static bool checkRollbackAtEqualTimes(std::ostream& details) {
+    System system(2, 0.5, 0.2);
+    IslandModel model;
+    model.numIslands = 2;
+    model.baseBirthRate = 0.5;
+    model.baseDeathRate = 0.2;
+    model.firstId = system.getNextPopulationId();
+    std::vector<double> barrierRow = system.getBarrierThresholds().getRow(1);
+    RandomService random(42);
+    const std::vector<double> resourceUse(3, 1.0);
+
+    // Immigrants from island 0, two of them at the same time
+    const double t = 1e-6;
+    std::vector<IslandMessage> messages;
+    for (double time : {0.5 * t, t, t, 2.0 * t, 1.5 * t}) {
+        IslandMessage message;
+        message.time = time;
+        message.sender = 0;
+        message.receiver = 1;
+        message.serial = messages.size();
+        message.migrant.emplace(model.firstId + 1000 + static_cast<PopulationId>(messages.size()), 1, std::nullopt,
+                                0.1, 0.1, resourceUse, 1.0);
+        messages.push_back(std::move(message));
+    }
+
+    // Saving every second step leaves a saved state between the two messages at t, the late one at 1.5 t rolls the
+    // island back into it
+    IslandProcess rolledBack(1, model, *system.getIsolation(1), barrierRow, random.stream(IslandStreamBase + 1), 2);
+    for (size_t i = 0; i < 4; ++i) {
+        rolledBack.receive(messages[i]);
+    }
+    while (rolledBack.nextTime() <= 2.0 * t) {
+        rolledBack.step();
+    }
+    rolledBack.receive(messages[4]);
+
+    IslandProcess reference(1, model, *system.getIsolation(1), barrierRow, random.stream(IslandStreamBase + 1), 2);
+    for (const IslandMessage& message : messages) {
+        reference.receive(message);
+    }
+    for (IslandProcess* process : {&rolledBack, &reference}) {
+        while (process->nextTime() <= 3.0 * t) {
+            process->step();
+        }
+    }
+    details << " | rollbacks: " << rolledBack.getRollbacks() << " | steps: " << rolledBack.getSteps() << " vs "
+            << reference.getSteps() << " | populations: " << rolledBack.getPopulations().size() << " vs "
+            << reference.getPopulations().size();
+    return rolledBack.getRollbacks() == 1 && rolledBack.getSteps() == reference.getSteps() &&
+           rolledBack.getPopulations().size() == reference.getPopulations().size() &&
+           reference.getPopulations().size() == messages.size();
+}
+
+// Check the id index against std::unordered_map under random inserts, overwrites and erases: it grows from empty past
+// several load factor doublings, churns near a load factor of 0.7 where probe runs are long and wrap around the end of
+// the table, then drains. Every operation is followed by lookups, and the whole key range is compared now and then.
+static bool checkIdIndex(std::ostream& details) {
+    RandomStream random = RandomService(11).stream(SelectionStream);
+    IdIndex index;
+    std::unordered_map<PopulationId, size_t> expected;
+    const size_t numKeys = 2000;                 // Keys are drawn from a range twice the peak size
+    size_t mismatches = 0;
+    size_t operations = 0;
+
+    auto compare = [&](PopulationId key) {
+        auto it = expected.find(key);
+        mismatches += index.find(key) != (it == expected.end() ? IdIndex::npos : it->second);
+    };
+    auto operate = [&](double insertShare) {
+        // Large multiples of a prime keep the keys far apart, as ids handed out in blocks are
+        auto key = static_cast<PopulationId>(random.uniformIndex(2 * numKeys)) * 1000003;
+        if (random.uniform() < insertShare) {
+            size_t position = random.uniformIndex(numKeys);
+            index.insert(key, position);
+            expected[key] = position;
+        } else {
+            mismatches += index.erase(key) != (expected.erase(key) == 1);
+        }
+        compare(key);
+        compare(static_cast<PopulationId>(random.uniformIndex(2 * numKeys)) * 1000003);
+        mismatches += index.size() != expected.size();
+        if (++operations % 1000 == 0) {
+            for (size_t k = 0; k < 2 * numKeys; ++k) {
+                compare(static_cast<PopulationId>(k) * 1000003);
+            }
+        }
+    };
+
+    while (expected.size() < numKeys) {
+        operate(0.9);
+    }
+    for (size_t i = 0; i < 100000; ++i) {
+        operate(0.5);
+    }
+
+    // Drain in random order, so erases hit the middle of runs as well as their ends
+    std::vector<PopulationId> keys;
+    for (const auto& [key, position] : expected) {
+        keys.push_back(key);
+    }
+    for (size_t i = keys.size(); i > 0; --i) {
+        std::swap(keys[i - 1], keys[random.uniformIndex(i)]);
+        mismatches += !index.erase(keys[i - 1]);
+        expected.erase(keys[i - 1]);
+        compare(keys[i - 1]);
+        compare(keys[random.uniformIndex(keys.size())]);
+        ++operations;
+    }
+    mismatches += index.size() != 0;
+    details << " | operations: " << operations << " | mismatches: " << mismatches;
+    return mismatches == 0;
+}
+
+// Check the handles of a population store under random adds and swap-removes: every live handle resolves to the row
+// of its population, also after the last row moved into a removed one, and every handle of a removed population stays
+// stale after its slot has been handed out again
+static bool checkPopulationHandles(std::ostream& details) {
+    RandomStream random = RandomService(13).stream(SelectionStream);
+    PopulationStore populations(nicheDimensions == dynamicNiches ? 3 : nicheDimensions);
+    const std::vector<double> resourceUse(populations.getNumberOfNiches(), 1.0);
+    std::vector<std::pair<PopulationId, PopulationHandle>> live;
+    std::vector<PopulationHandle> removed;
+    PopulationId nextId = 0;
+    size_t mismatches = 0;
+    size_t reusedSlots = 0;
+
+    for (size_t operation = 0; operation < 20000; ++operation) {
+        if (live.empty() || random.uniform() < 0.55) {
+            PopulationHandle handle = populations.add(UnitPopulation(nextId, 0, std::nullopt, 0.1, 0.1, resourceUse, 1.0));
+            reusedSlots += std::any_of(removed.begin(), removed.end(),
+                                       [handle](const PopulationHandle& old) { return old.slot == handle.slot; });
+            live.emplace_back(nextId++, handle);
+        } else {
+            size_t victim = random.uniformIndex(live.size());
+            mismatches += !populations.remove(live[victim].second);
+            removed.push_back(live[victim].second);
+            live[victim] = live.back();
+            live.pop_back();
+        }
+
+        for (const auto& [id, handle] : live) {
+            size_t index = populations.indexOf(handle);
+            mismatches += index == PopulationStore::npos || populations[index].getId() != id ||
+                          populations.find(id) != index;
+        }
+        if (operation % 100 == 0) {
+            for (const PopulationHandle& handle : removed) {
+                mismatches += populations.contains(handle) || populations.indexOf(handle) != PopulationStore::npos ||
+                              populations.remove(handle);
+            }
+        }
+    }
+    details << " | handles given out: " << nextId << " | slots reused: " << reusedSlots << " | handle mismatches: "
+            << mismatches;
+    return mismatches == 0 && reusedSlots > 0;
+}
+
+// Check Philox4x32-10 against the known-answer vectors published with Random123 (kat_vectors, philox4x32_10), and the
+// bulk fills against the scalar draws they replace: the same values and the same stream position afterwards, starting
+// from every word offset within a block so values straddling two blocks are covered
+static bool checkRandomStreams(std::ostream& details) {
+    struct KnownAnswer {
+        std::array<uint32_t, 4> counter;
+        std::array<uint32_t, 2> key;
+        std::array<uint32_t, 4> output;
+    };
+    const KnownAnswer knownAnswers[] = {
+            {{0x00000000, 0x00000000, 0x00000000, 0x00000000}, {0x00000000, 0x00000000},
+             {0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8}},
+            {{0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff}, {0xffffffff, 0xffffffff},
+             {0x408f276d, 0x41c83b0e, 0xa20bc7c6, 0x6d5451fd}},
+            {{0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344}, {0xa4093822, 0x299f31d0},
+             {0xd16cfe09, 0x94fdcceb, 0x5001e420, 0x24126ea1}}};
+    size_t wrongAnswers = 0;
+    for (const KnownAnswer& answer : knownAnswers) {
+        wrongAnswers += philox4x32(answer.counter, answer.key) != answer.output;
+    }
+
+    size_t mismatches = 0;
+    size_t fills = 0;
+    std::vector<uint64_t> bits;
+    std::vector<double> values;
+    for (size_t offset = 0; offset < 4; ++offset) {
+        for (size_t count : {0, 1, 2, 3, 7, 64, 65, 130, 1001}) {
+            RandomStream bulk = RandomService(17).stream(LeapStream);
+            RandomStream scalar = bulk;
+            for (size_t i = 0; i < offset; ++i) {
+                bulk();
+                scalar();
+            }
+
+            bits.resize(count);
+            bulk.fill64(bits.data(), count);
+            for (uint64_t value : bits) {
+                mismatches += value != scalar.next64();
+            }
+            values.resize(count);
+            bulk.fillUniform(values.data(), count);
+            for (double value : values) {
+                mismatches += value != scalar.uniform();
+            }
+            bulk.fillExponential(values.data(), count, 2.5);
+            for (double value : values) {
+                mismatches += value != scalar.exponential(2.5);
+            }
+            mismatches += bulk() != scalar();
+            fills += 3;
+        }
+    }
+    details << " | wrong known answers: " << wrongAnswers << " | bulk fills: " << fills << " | mismatches: "
+            << mismatches;
+    return wrongAnswers == 0 && mismatches == 0;
+}
+
+// Print one line of the barrier layout comparison
+static void reportBarrierLayout(const std::string& name, size_t numIsolations, size_t bytes, double updateNanoseconds,
+                                double rowNanoseconds, double checksum) {
+    std::cout << name << " | isolations: " << numIsolations << " | " << static_cast<double>(bytes) / (1024.0 * 1024.0)
+              << " MiB | " << updateNanoseconds << " ns/update | " << rowNanoseconds << " ns/row sum | checksum: "
+              << checksum << "\n";
+}
+
+// Compare the barrier layouts on what the rate engine does with them: symmetric updates, and sums of 1 - barrier over
+// whole rows after a barrier change
+static void benchmarkBarrierLayouts(size_t numIsolations) {
+    const size_t numUpdates = 1000000;
+    const size_t rowSweeps = std::max<size_t>(1, 20000000 / (numIsolations * numIsolations));
+    RandomStream random = RandomService(42).stream(SelectionStream);
+    std::vector<std::pair<int, int>> pairs(numUpdates);
+    std::vector<double> thresholds(numUpdates);
+    for (size_t i = 0; i < numUpdates; ++i) {
+        pairs[i] = {static_cast<int>(random.uniformIndex(numIsolations)), static_cast<int>(random.uniformIndex(numIsolations))};
+        thresholds[i] = random.uniform();
+    }
+    auto elapsed = [](auto start, size_t count) {
+        return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() /
+               static_cast<double>(count);
+    };
+
+    // Row of vectors, the layout System used to have
+    {
+        std::vector<std::vector<double>> rows(numIsolations, std::vector<double>(numIsolations, 1.0));
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < numUpdates; ++i) {
+            rows[pairs[i].first][pairs[i].second] = thresholds[i];
+            rows[pairs[i].second][pairs[i].first] = thresholds[i];
+        }
+        double update = elapsed(start, numUpdates);
+
+        double checksum = 0.0;
+        start = std::chrono::steady_clock::now();
+        for (size_t sweep = 0; sweep < rowSweeps; ++sweep) {
+            for (size_t a = 0; a < numIsolations; ++a) {
+                double sum = 0.0;
+                for (size_t b = 0; b < numIsolations; ++b) {
+                    if (b != a) {
+                        sum += 1.0 - rows[a][b];
+                    }
+                }
+                checksum += sum;
+            }
+        }
+        reportBarrierLayout("Row of vectors", numIsolations, numIsolations * (numIsolations * sizeof(double) + sizeof(rows[0])),
+                            update, elapsed(start, rowSweeps * numIsolations), checksum);
+    }
+
+    // Aligned full matrix at every instruction set, then the packed triangle
+    SimdLevel detected = detectSimdLevel();
+    for (auto [layout, level] : {std::pair{BarrierMatrix::Layout::Full, SimdLevel::Scalar},
+                                 std::pair{BarrierMatrix::Layout::Full, SimdLevel::AVX2},
+                                 std::pair{BarrierMatrix::Layout::Full, SimdLevel::AVX512},
+                                 std::pair{BarrierMatrix::Layout::Packed, SimdLevel::Scalar}}) {
+        if (level > detected) {
+            continue;
+        }
+        BarrierMatrix matrix(numIsolations, layout);
+        matrix.setSimdLevel(level);
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < numUpdates; ++i) {
+            matrix.set(pairs[i].first, pairs[i].second, thresholds[i]);
+        }
+        double update = elapsed(start, numUpdates);
+
+        double checksum = 0.0;
+        start = std::chrono::steady_clock::now();
+        for (size_t sweep = 0; sweep < rowSweeps; ++sweep) {
+            for (size_t a = 0; a < numIsolations; ++a) {
+                checksum += matrix.emigrationWeight(static_cast<int>(a));
+            }
+        }
+        std::string name = layout == BarrierMatrix::Layout::Full ? std::string("Aligned full, ") + simdLevelName(level)
+                                                                 : std::string("Packed triangle");
+        reportBarrierLayout(name, numIsolations, matrix.getStorageBytes(), update,
+                            elapsed(start, rowSweeps * numIsolations), checksum);
+    }
+}
+
+// Time a whole ensemble of short replicates for a number of worker threads
+static void benchmarkEnsemble(size_t numThreads, size_t numReplicates) {
+    EnsembleSettings settings;
+    settings.maxTime = 8.0;
+    settings.numReplicates = numReplicates;
+    settings.seed = 42;
+    settings.numThreads = numThreads;
+
+    EnsembleRunner runner(settings);
+    auto start = std::chrono::steady_clock::now();
+    auto results = runner.run();
+    auto end = std::chrono::steady_clock::now();
+
+    size_t events = 0;
+    for (const auto& result : results) {
+        events += result.observer.getEventHistory().size();
+    }
+    double seconds = std::chrono::duration<double>(end - start).count();
+    std::cout << "Ensemble | threads: " << numThreads << " | replicates: " << numReplicates << " | " << seconds << " s"
+              << " | " << static_cast<double>(events) / seconds << " events/s | steals: " << runner.getNumberOfSteals() << "\n";
+}
+
+// Time the Time Warp engine on many islands for a number of worker threads
+static void benchmarkTimeWarp(size_t numThreads, int numIsolations, double maxTime) {
+    bool wasVerbose = System::isVerbose();
+    System::setVerbose(false);
+    Director director(numIsolations, 0.5, 0.2, SamplingMethod::SumTree, 42);
+    TimeWarpSettings settings;
+    settings.numThreads = numThreads;
+    settings.window = 0.25;
+    TimeWarpStatistics statistics = director.simulateTimeWarp(maxTime, settings);
+    System::setVerbose(wasVerbose);
+
+    std::cout << "Time Warp | threads: " << statistics.numThreads << " | islands: " << numIsolations << " | "
+              << statistics.wallSeconds << " s | committed: " << statistics.committedSteps << " | undone: "
+              << statistics.rolledBackSteps << " | rollbacks: " << statistics.rollbacks << " | anti-messages: "
+              << statistics.antiMessages << "\n";
+}
+
+// Run the conservative engine on islands walled off by default, reporting the parallelism the lookahead allows
+static void benchmarkConservative(size_t numThreads, int numIsolations, double maxTime) {
+    bool wasVerbose = System::isVerbose();
+    System::setVerbose(false);
+    Director director(numIsolations, 0.5, 0.2, SamplingMethod::SumTree, 42);
+    ConservativeSettings settings;
+    settings.numThreads = numThreads;
+    ConservativeStatistics statistics = director.simulateConservative(maxTime, settings);
+    System::setVerbose(wasVerbose);
+
+    double blocked = 0.0;
+    for (const ConservativeWorkerStatistics& worker : statistics.workers) {
+        blocked = std::max(blocked, worker.blockedSeconds);
+    }
+    std::cout << "Conservative | threads: " << statistics.numThreads << " | islands: " << numIsolations << " | "
+              << statistics.wallSeconds << " s | steps: " << statistics.committedSteps << " | rounds: "
+              << statistics.rounds << " | parallelism: " << statistics.parallelism << " | most blocked: " << blocked
+              << " s\n";
+}
+
+int main(int argc, char** argv) {
+    // Checks first, "--checks" runs nothing else
+    std::cout << "Checks:\n";
+    bool passed = runCheck("Niche dimensions", checkNicheDimensions);
+    passed = runCheck("Sparse barrier changes", [](std::ostream& details) {
+        return checkSparseBarrierChanges(details, 10000, 100000);
+    }) && passed;
+    passed = runCheck("Rollback at equal times", checkRollbackAtEqualTimes) && passed;
+    for (SamplingMethod method : {SamplingMethod::Direct, SamplingMethod::SumTree, SamplingMethod::CompositionRejection,
+                                   SamplingMethod::NextReaction, SamplingMethod::Hierarchical}) {
+        passed = runCheck("Steady-state stepping", [method](std::ostream& details) {
+            return checkStepAllocations(details, method, 2000, 2000);
+        }) && passed;
+    }
+    passed = runCheck("Id index and population handles", [](std::ostream& details) {
+        bool indexPassed = checkIdIndex(details);
+        return checkPopulationHandles(details) && indexPassed;
+    }) && passed;
+    passed = runCheck("Random streams", checkRandomStreams) && passed;
+    passed = runCheck("Event log round trip", checkEventLog) && passed;
+    passed = runCheck("Event file round trip", checkEventFile) && passed;
+    passed = runCheck("Compressed event file round trip", checkCompressedEventFile) && passed;
+    if (argc > 1 && std::string(argv[1]) == "--checks") {
+        return passed ? 0 : 1;
+    }
+
+    std::cout << "Event selection (sample + update), rates spanning 1e-3 to 1e3:\n";
+    for (size_t numEvents : {1000, 10000, 100000, 1000000}) {
+        for (SamplingMethod method : {SamplingMethod::Direct, SamplingMethod::SumTree, SamplingMethod::CompositionRejection,
+                                       SamplingMethod::NextReaction, SamplingMethod::Hierarchical}) {
+            if (method == SamplingMethod::Direct && numEvents > 100000) {
+                continue;   // Too slow to be worth waiting for
+            }
+            benchmarkSelector(method, numEvents, 1000, 20000);
+        }
+    }
+
+    std::cout << "Exact simulation loop:\n";
+    for (SamplingMethod method : {SamplingMethod::SumTree, SamplingMethod::Hierarchical}) {
+        benchmarkSimulation(method, 3, 12.0);
+        benchmarkSimulation(method, 3, 12.0, true);
+    }
+
+    std::cout << "Event history sinks:\n";
+    benchmarkEventSink("In memory", nullptr, 14.0);
+    for (Backpressure backpressure : {Backpressure::Block, Backpressure::Drop, Backpressure::Sample}) {
+        EventStreamSettings streamSettings;
+        streamSettings.backpressure = backpressure;
+        streamSettings.ringCapacity = 4096;
+        benchmarkEventSink(backpressure == Backpressure::Block ? "Streamed, block"
+                           : backpressure == Backpressure::Drop ? "Streamed, drop" : "Streamed, sample",
+                           &streamSettings, 14.0);
+    }
+
+    benchmarkEventFile(14.0);
+    benchmarkCompressedEventFile(14.0);
+
+    std::cout << "Population removal by id:\n";
+    for (size_t numPopulations : {1000, 10000, 100000}) {
+        benchmarkPopulationChurn(numPopulations, 200000);
+    }
+
+    std::cout << "Niche competition kernel:\n";
+    for (size_t numPopulations : {1000, 10000, 100000}) {
+        benchmarkNicheKernel(numPopulations, nicheDimensions == dynamicNiches ? 3 : nicheDimensions);
+    }
+
+    std::cout << "Barrier matrix layouts:\n";
+    for (size_t numIsolations : {64, 512, 4096}) {
+        benchmarkBarrierLayouts(numIsolations);
+    }
+
+    std::cout << "Replicate ensemble on a work-stealing pool:\n";
+    size_t maxThreads = std::max<size_t>(1, std::thread::hardware_concurrency());
+    for (size_t numThreads = 1; numThreads <= maxThreads; numThreads *= 2) {
+        benchmarkEnsemble(numThreads, 128);
+    }
+
+    std::cout << "Islands in parallel with Time Warp:\n";
+    for (size_t numThreads = 1; numThreads <= maxThreads; numThreads *= 2) {
+        benchmarkTimeWarp(numThreads, 16, 3.0);
+    }
+
+    std::cout << "Islands in parallel with conservative lookahead:\n";
+    for (size_t numThreads = 1; numThreads <= maxThreads; numThreads *= 2) {
+        benchmarkConservative(numThreads, 64, 2.0);
+    }
+
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,116 @@
+//
+// Created by Tianjian Qin on 10/16/2026.
+// Variable-length byte codes shared by the compressed event files and the event log
+//
+
+#ifndef FUSION_BYTE_CODEC_H
+#define FUSION_BYTE_CODEC_H
+
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+inline uint64_t zigzagEncode(int64_t value) {
+    return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+}
+
+inline int64_t zigzagDecode(uint64_t value) {
+    return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+inline void putVarint(uint64_t value, std::vector<unsigned char>& out) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<unsigned char>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<unsigned char>(value));
+}
+
+// A value XOR another as one byte with the numbers of zero bytes on top and at the bottom (8 on top for zero), followed
+// by the bytes in between
+inline void putXor(uint64_t value, std::vector<unsigned char>& out) {
+    if (value == 0) {
+        out.push_back(0x80);
+        return;
+    }
+    int leading = std::countl_zero(value) / 8;
+    int trailing = std::countr_zero(value) / 8;
+    out.push_back(static_cast<unsigned char>(leading << 4 | trailing));
+    value >>= 8 * trailing;
+    for (int i = 0; i < 8 - leading - trailing; ++i) {
+        out.push_back(static_cast<unsigned char>(value >> (8 * i)));
+    }
+}
+
+// Reads the fields of a block in order, throws on a block that ends early
+class BlockDecoder {
+private:
+    const unsigned char* position;
+    const unsigned char* end;
+
+    void require(size_t bytes) const {
+        if (static_cast<size_t>(end - position) < bytes) {
+            throw std::runtime_error("Compressed event block is truncated");
+        }
+    }
+
+public:
+    BlockDecoder(const unsigned char* data, size_t bytes) : position(data), end(data + bytes) {}
+
+    // Get the first byte not read yet
+    [[nodiscard]] const unsigned char* getPosition() const {
+        return position;
+    }
+
+    uint8_t byte() {
+        require(1);
+        return *position++;
+    }
+
+    const unsigned char* bytes(size_t count) {
+        require(count);
+        const unsigned char* start = position;
+        position += count;
+        return start;
+    }
+
+    uint64_t varint() {
+        uint64_t value = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            uint8_t next = byte();
+            value |= static_cast<uint64_t>(next & 0x7f) << shift;
+            if ((next & 0x80) == 0) {
+                return value;
+            }
+        }
+        throw std::runtime_error("Compressed event block has an overlong varint");
+    }
+
+    int64_t signedVarint() {
+        return zigzagDecode(varint());
+    }
+
+    uint64_t xorValue() {
+        uint8_t lengths = byte();
+        int leading = lengths >> 4;
+        int trailing = lengths & 0x0f;
+        if (leading >= 8) {
+            return 0;
+        }
+        if (leading + trailing > 8) {
+            throw std::runtime_error("Compressed event block has a malformed value");
+        }
+        const unsigned char* middle = bytes(static_cast<size_t>(8 - leading - trailing));
+        uint64_t value = 0;
+        for (int i = 0; i < 8 - leading - trailing; ++i) {
+            value |= static_cast<uint64_t>(middle[i]) << (8 * i);
+        }
+        return value << (8 * trailing);
+    }
+};
+
+
+#endif //FUSION_BYTE_CODEC_H
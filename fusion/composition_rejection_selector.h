@@ -0,0 +1,196 @@
+//
+// Created by Tianjian Qin on 10/16/2026.
+// Class definition for the composition-rejection selector, which bins rates into power-of-two groups
+//
+
+#ifndef FUSION_COMPOSITION_REJECTION_SELECTOR_H
+#define FUSION_COMPOSITION_REJECTION_SELECTOR_H
+
+
+#include <algorithm>
+#include <cmath>
+#include <unordered_map>
+#include <vector>
+#include "event_selector.h"
+
+// Composition-rejection selector, a group is picked by its total rate and an event inside it by rejection sampling
+class CompositionRejectionSelector : public EventSelector {
+private:
+    // Rates r with 2^(exponent-1) <= r < 2^exponent
+    struct RateGroup {
+        int exponent;
+        double upperBound;               // 2^exponent, bounds every rate in the group
+        double totalRate = 0.0;          // Sum of the rates in the group
+        std::vector<size_t> members;     // Indices of the entries in the group
+        size_t deltaUpdates = 0;         // Changes applied to totalRate as deltas since it was last re-summed
+    };
+
+    // Where an entry lives
+    struct EntrySlot {
+        double rate;
+        size_t group;                    // Position in groups, npos for zero rates
+        size_t member;                   // Position in the group's members
+    };
+
+    static constexpr size_t resumInterval = 1024;         // Fewest delta updates between re-sums of a group
+
+    std::vector<EntrySlot> slots;                        // Per entry index
+    std::vector<RateGroup> groups;                       // Groups created so far, never removed
+    std::unordered_map<int, size_t> groupByExponent;     // Exponent -> position in groups
+    double totalRate = 0.0;                              // Sum of the group totals, kept up to date
+
+    // Change the total of a group by a delta. The deltas leave rounding errors behind that would pile up over a long
+    // run and bias the choice of group, so the group is re-summed from its members once it has seen as many delta
+    // updates as it has members (at least resumInterval, which keeps the cost O(1) amortized), and the running total
+    // is re-summed from the groups along with it. An emptied group starts over at zero.
+    void adjustGroup(RateGroup& group, double delta) {
+        double before = group.totalRate;
+        if (group.members.empty()) {
+            group.totalRate = 0.0;
+            group.deltaUpdates = 0;
+        } else if (++group.deltaUpdates >= std::max(resumInterval, group.members.size())) {
+            group.totalRate = 0.0;
+            for (size_t member : group.members) {
+                group.totalRate += slots[member].rate;
+            }
+            group.deltaUpdates = 0;
+            totalRate = 0.0;
+            for (const RateGroup& other : groups) {
+                totalRate += other.totalRate;
+            }
+            return;
+        } else {
+            group.totalRate += delta;
+        }
+        totalRate += group.totalRate - before;
+    }
+
+    // Find or create the group for a positive rate
+    size_t groupFor(double rate) {
+        int exponent;
+        std::frexp(rate, &exponent);
+        auto it = groupByExponent.find(exponent);
+        if (it != groupByExponent.end()) {
+            return it->second;
+        }
+        groups.push_back({exponent, std::ldexp(1.0, exponent), 0.0, {}, 0});
+        groupByExponent.emplace(exponent, groups.size() - 1);
+        return groups.size() - 1;
+    }
+
+    // Put an entry in the group matching its rate
+    void insert(size_t index) {
+        EntrySlot& slot = slots[index];
+        if (slot.rate <= 0.0) {
+            slot.group = npos;
+            return;
+        }
+        slot.group = groupFor(slot.rate);
+        RateGroup& group = groups[slot.group];
+        slot.member = group.members.size();
+        group.members.push_back(index);
+        adjustGroup(group, slot.rate);
+    }
+
+    // Take an entry out of its group
+    void extract(size_t index) {
+        EntrySlot& slot = slots[index];
+        if (slot.group == npos) {
+            return;
+        }
+        RateGroup& group = groups[slot.group];
+        size_t moved = group.members.back();
+        group.members[slot.member] = moved;
+        slots[moved].member = slot.member;
+        group.members.pop_back();
+        slot.group = npos;
+        adjustGroup(group, -slot.rate);
+    }
+
+public:
+    void clear() override {
+        slots.clear();
+        groups.clear();
+        groupByExponent.clear();
+        totalRate = 0.0;
+    }
+
+    void add(double rate, int) override {
+        slots.push_back({rate, npos, 0});
+        insert(slots.size() - 1);
+    }
+
+    // Groups created so far may come to hold all entries, a rate in a new group still allocates that group
+    void reserve(size_t numEntries) override {
+        slots.reserve(numEntries);
+        for (RateGroup& group : groups) {
+            group.members.reserve(numEntries);
+        }
+    }
+
+    void update(size_t index, double rate) override {
+        EntrySlot& slot = slots[index];
+        if (slot.group != npos && rate > 0.0 && rate < groups[slot.group].upperBound
+            && rate >= 0.5 * groups[slot.group].upperBound) {
+            // Stays in the same group, the rate is set first so a re-sum of the group sees it
+            double delta = rate - slot.rate;
+            slot.rate = rate;
+            adjustGroup(groups[slot.group], delta);
+            return;
+        }
+        extract(index);
+        slot.rate = rate;
+        insert(index);
+    }
+
+    void remove(size_t index) override {
+        extract(index);
+        size_t last = slots.size() - 1;
+        if (index != last) {
+            slots[index] = slots[last];
+            if (slots[index].group != npos) {
+                groups[slots[index].group].members[slots[index].member] = index;
+            }
+        }
+        slots.pop_back();
+    }
+
+    [[nodiscard]] double getTotalRate() const override {
+        return totalRate;
+    }
+
+    std::pair<double, size_t> sampleNext(RandomStream& random) override {
+        if (totalRate <= 0.0) {
+            return {std::numeric_limits<double>::infinity(), npos}; // Nothing can happen anymore
+        }
+
+        // Sample the waiting time for the next event (exponentially distributed)
+        double waitingTime = random.exponential(totalRate);
+
+        // Composition: pick a group by its share of the total rate
+        double threshold = random.uniform() * totalRate;
+        const RateGroup* chosen = nullptr;
+        double cumulativeRate = 0.0;
+        for (const auto& group : groups) {
+            if (group.members.empty()) {
+                continue;
+            }
+            chosen = &group;
+            cumulativeRate += group.totalRate;
+            if (cumulativeRate >= threshold) {
+                break;
+            }
+        }
+
+        // Rejection: every rate in the group is at least half its bound, so on average fewer than two tries
+        while (true) {
+            size_t index = chosen->members[random.uniformIndex(chosen->members.size())];
+            if (random.uniform() * chosen->upperBound < slots[index].rate) {
+                return {waitingTime, index};
+            }
+        }
+    }
+};
+
+
+#endif //FUSION_COMPOSITION_REJECTION_SELECTOR_H
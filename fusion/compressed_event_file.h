@@ -0,0 +1,349 @@
+//
+// Created by Tianjian Qin on 10/16/2026.
+// Layout of compressed event history files, the codec of their blocks and the class writing them
+//
+
+#ifndef FUSION_COMPRESSED_EVENT_FILE_H
+#define FUSION_COMPRESSED_EVENT_FILE_H
+
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "byte_codec.h"
+#include "event_log.h"
+
+// How the times of a block are encoded, relative to the time before in the block
+enum class TimeEncoding : uint32_t {
+    Delta,                          // Zigzag varint of the difference of the bit patterns, small for close times
+    Xor                             // Bit pattern XOR the previous one, only its nonzero middle bytes are stored
+};
+
+// A compressed event history file is
+// - a 64-byte header, rewritten when the file is closed,
+// - blocks of up to blockRecords records, each encoded on its own so blocks can be decoded in any order,
+// - the block index, one entry per block with its offset, size and the time and id ranges of its records,
+// - the names of the mutated properties the records refer to, each a 32-bit length followed by the characters.
+// A block starts with its dictionary of event types (a count, then the types) and the type of every record as a code
+// of 0, 1 or 2 bits into it, packed. The fields of every record follow, only those its type uses: the time, the
+// population as a zigzag varint of the difference to the population before, the parent as the difference to the
+// population, islands and property indices as zigzag varints, the old value of a mutation raw and the new one XOR the
+// old. Numbers are stored in the byte order of the machine that wrote the file.
+struct CompressedEventFileHeader {
+    char magic[8];                  // "FUSIONCZ"
+    uint32_t version;               // Layout version
+    uint32_t timeEncoding;          // TimeEncoding of every block
+    uint64_t numRecords;            // Number of records
+    uint64_t dictionaryOffset;      // Offset of the property names, 0 while the file is being written
+    uint32_t numProperties;         // Number of property names
+    uint32_t blockRecords;          // Records per block
+    uint64_t indexOffset;           // Offset of the block index
+    uint64_t numBlocks;             // Number of blocks
+    uint64_t reserved;
+};
+
+// Index entry of a compressed block, where it is and the ranges of times and of population and parent ids in it
+struct CompressedBlockEntry {
+    uint64_t offset;
+    uint32_t bytes;
+    uint32_t numRecords;
+    double minTime;
+    double maxTime;
+    int64_t minPopulation;
+    int64_t maxPopulation;
+};
+
+inline constexpr char compressedEventFileMagic[8] = {'F', 'U', 'S', 'I', 'O', 'N', 'C', 'Z'};
+inline constexpr uint32_t compressedEventFileVersion = 1;
+
+static_assert(sizeof(CompressedEventFileHeader) == 64, "Compressed event file headers are 64 bytes");
+static_assert(sizeof(CompressedBlockEntry) == 48, "Compressed block entries are 48 bytes");
+
+// Encode records as one block, appended to out. Fields a record's type does not use must hold -1 (or 0 for the values),
+// as the Observer logs them, they are not stored.
+inline void encodeEventBlock(const EventRecord* records, size_t count, TimeEncoding timeEncoding,
+                             std::vector<unsigned char>& out) {
+    // Dictionary of the types present, in the order of EventType
+    uint8_t codes[4] = {0, 0, 0, 0};
+    bool present[4] = {false, false, false, false};
+    for (size_t i = 0; i < count; ++i) {
+        present[static_cast<uint8_t>(records[i].type) & 3] = true;
+    }
+    uint8_t numTypes = 0;
+    out.push_back(0);
+    size_t countPosition = out.size() - 1;
+    for (uint8_t type = 0; type < 4; ++type) {
+        if (present[type]) {
+            codes[type] = numTypes++;
+            out.push_back(type);
+        }
+    }
+    out[countPosition] = numTypes;
+    int width = numTypes <= 1 ? 0 : numTypes <= 2 ? 1 : 2;
+    size_t codesPosition = out.size();
+    out.resize(out.size() + (count * width + 7) / 8, 0);
+    for (size_t i = 0; i < count && width > 0; ++i) {
+        size_t bit = i * width;
+        uint8_t code = codes[static_cast<uint8_t>(records[i].type)];
+        out[codesPosition + bit / 8] |= static_cast<unsigned char>(code << (bit % 8));
+    }
+
+    uint64_t previousTime = 0;
+    PopulationId previousPopulation = 0;
+    for (size_t i = 0; i < count; ++i) {
+        const EventRecord& record = records[i];
+        auto time = std::bit_cast<uint64_t>(record.time);
+        if (timeEncoding == TimeEncoding::Delta) {
+            putVarint(zigzagEncode(static_cast<int64_t>(time - previousTime)), out);
+        } else {
+            putXor(time ^ previousTime, out);
+        }
+        previousTime = time;
+        putVarint(zigzagEncode(record.population - previousPopulation), out);
+        previousPopulation = record.population;
+
+        switch (record.type) {
+            case EventType::Birth:
+                putVarint(zigzagEncode(record.parent - record.population), out);
+                putVarint(zigzagEncode(record.source), out);
+                break;
+            case EventType::Immigration:
+                putVarint(zigzagEncode(record.parent - record.population), out);
+                putVarint(zigzagEncode(record.source), out);
+                putVarint(zigzagEncode(record.target), out);
+                break;
+            case EventType::Mutation: {
+                putVarint(zigzagEncode(record.source), out);
+                putVarint(zigzagEncode(record.property), out);
+                auto oldValue = std::bit_cast<uint64_t>(record.oldValue);
+                for (int byte = 0; byte < 8; ++byte) {
+                    out.push_back(static_cast<unsigned char>(oldValue >> (8 * byte)));
+                }
+                putXor(std::bit_cast<uint64_t>(record.newValue) ^ oldValue, out);
+                break;
+            }
+            case EventType::Death:
+                break;
+        }
+    }
+}
+
+// Decode a block of count records written by encodeEventBlock, throws if it is malformed
+inline void decodeEventBlock(const unsigned char* data, size_t bytes, size_t count, TimeEncoding timeEncoding,
+                             EventRecord* records) {
+    BlockDecoder in(data, bytes);
+    uint8_t numTypes = in.byte();
+    if (numTypes == 0 ? count > 0 : numTypes > 4) {
+        throw std::runtime_error("Compressed event block has a malformed type dictionary");
+    }
+    EventType types[4] = {EventType::Birth, EventType::Birth, EventType::Birth, EventType::Birth};
+    for (uint8_t code = 0; code < numTypes; ++code) {
+        uint8_t type = in.byte();
+        if (type > static_cast<uint8_t>(EventType::Mutation)) {
+            throw std::runtime_error("Compressed event block has an unknown event type");
+        }
+        types[code] = static_cast<EventType>(type);
+    }
+    int width = numTypes <= 1 ? 0 : numTypes <= 2 ? 1 : 2;
+    const unsigned char* codes = in.bytes((count * width + 7) / 8);
+
+    uint64_t previousTime = 0;
+    PopulationId previousPopulation = 0;
+    for (size_t i = 0; i < count; ++i) {
+        size_t bit = i * width;
+        unsigned code = width > 0 ? (codes[bit / 8] >> (bit % 8)) & ((1u << width) - 1) : 0;
+        if (code >= numTypes) {
+            throw std::runtime_error("Compressed event block has a malformed type code");
+        }
+        EventRecord& record = records[i];
+        record = {types[code], 0.0, -1, -1, -1, -1, -1, 0.0, 0.0};
+        uint64_t time = timeEncoding == TimeEncoding::Delta
+                        ? previousTime + static_cast<uint64_t>(in.signedVarint())
+                        : previousTime ^ in.xorValue();
+        record.time = std::bit_cast<double>(time);
+        previousTime = time;
+        record.population = previousPopulation + in.signedVarint();
+        previousPopulation = record.population;
+
+        switch (record.type) {
+            case EventType::Birth:
+                record.parent = record.population + in.signedVarint();
+                record.source = in.signedVarint();
+                break;
+            case EventType::Immigration:
+                record.parent = record.population + in.signedVarint();
+                record.source = in.signedVarint();
+                record.target = in.signedVarint();
+                break;
+            case EventType::Mutation: {
+                record.source = in.signedVarint();
+                record.property = in.signedVarint();
+                const unsigned char* raw = in.bytes(8);
+                uint64_t oldValue = 0;
+                for (int byte = 0; byte < 8; ++byte) {
+                    oldValue |= static_cast<uint64_t>(raw[byte]) << (8 * byte);
+                }
+                record.oldValue = std::bit_cast<double>(oldValue);
+                record.newValue = std::bit_cast<double>(oldValue ^ in.xorValue());
+                break;
+            }
+            case EventType::Death:
+                break;
+        }
+    }
+}
+
+// Writes records to a compressed event file, encoding and writing each block once it is full. Only the records of the
+// block being filled, its encoding and the block index are held in memory.
+class CompressedEventFileWriter {
+public:
+    static constexpr size_t defaultBlockRecords = 4096;
+
+private:
+    std::ofstream file;
+    size_t blockRecords;
+    TimeEncoding timeEncoding;
+    std::vector<EventRecord> block;              // Records of the current block
+    std::vector<unsigned char> encoded;          // Encoding of the last block written
+    CompressedBlockEntry entry{};                // Index entry of the current block
+    std::vector<CompressedBlockEntry> index;     // Entries of the written blocks
+    uint64_t offset = sizeof(CompressedEventFileHeader);
+    uint64_t numRecords = 0;
+    uint64_t writes = 0;
+    bool open = true;
+
+    void writeHeader(uint64_t dictionaryOffset, uint64_t indexOffset, size_t numProperties) {
+        CompressedEventFileHeader header{};
+        std::memcpy(header.magic, compressedEventFileMagic, sizeof(header.magic));
+        header.version = compressedEventFileVersion;
+        header.timeEncoding = static_cast<uint32_t>(timeEncoding);
+        header.numRecords = numRecords;
+        header.dictionaryOffset = dictionaryOffset;
+        header.numProperties = static_cast<uint32_t>(numProperties);
+        header.blockRecords = static_cast<uint32_t>(blockRecords);
+        header.indexOffset = indexOffset;
+        header.numBlocks = index.size();
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    }
+
+    void resetBlock() {
+        block.clear();
+        entry = {0, 0, 0, std::numeric_limits<double>::infinity(), -std::numeric_limits<double>::infinity(),
+                 std::numeric_limits<int64_t>::max(), std::numeric_limits<int64_t>::min()};
+    }
+
+    void addToRange(PopulationId id) {
+        if (id >= 0) {
+            entry.minPopulation = std::min(entry.minPopulation, id);
+            entry.maxPopulation = std::max(entry.maxPopulation, id);
+        }
+    }
+
+    // Encode the current block and write it
+    void writeBlock() {
+        if (block.empty()) {
+            return;
+        }
+        encoded.clear();
+        encodeEventBlock(block.data(), block.size(), timeEncoding, encoded);
+        file.write(reinterpret_cast<const char*>(encoded.data()), static_cast<std::streamsize>(encoded.size()));
+        if (!file) {
+            throw std::runtime_error("Writing the event file failed");
+        }
+        ++writes;
+        entry.offset = offset;
+        entry.bytes = static_cast<uint32_t>(encoded.size());
+        entry.numRecords = static_cast<uint32_t>(block.size());
+        offset += encoded.size();
+        index.push_back(entry);
+        resetBlock();
+    }
+
+public:
+    // Create the file, throws if it cannot be opened
+    explicit CompressedEventFileWriter(const std::string& path, size_t recordsPerBlock = defaultBlockRecords,
+                                       TimeEncoding encoding = TimeEncoding::Delta)
+            : file(path, std::ios::binary | std::ios::trunc), blockRecords(std::max<size_t>(recordsPerBlock, 1)),
+              timeEncoding(encoding) {
+        if (!file) {
+            throw std::runtime_error("Cannot open event file " + path);
+        }
+        block.reserve(blockRecords);
+        writeHeader(0, 0, 0);
+        resetBlock();
+    }
+
+    CompressedEventFileWriter(const CompressedEventFileWriter&) = delete;
+    CompressedEventFileWriter& operator=(const CompressedEventFileWriter&) = delete;
+
+    // Append a record, throws if writing the block it completes fails
+    void append(const EventRecord& record) {
+        block.push_back(record);
+        entry.minTime = std::min(entry.minTime, record.time);
+        entry.maxTime = std::max(entry.maxTime, record.time);
+        addToRange(record.population);
+        addToRange(record.parent);
+        ++numRecords;
+        if (block.size() == blockRecords) {
+            writeBlock();
+        }
+    }
+
+    // Write the last block, the index and the property names the records refer to by index, then complete the header.
+    // Throws if anything could not be written.
+    void close(const std::vector<std::string>& propertyNames) {
+        if (!open) {
+            return;
+        }
+        open = false;
+        writeBlock();
+        uint64_t indexOffset = offset;
+        file.write(reinterpret_cast<const char*>(index.data()),
+                   static_cast<std::streamsize>(index.size() * sizeof(CompressedBlockEntry)));
+        uint64_t dictionaryOffset = indexOffset + index.size() * sizeof(CompressedBlockEntry);
+        for (const std::string& name : propertyNames) {
+            auto length = static_cast<uint32_t>(name.size());
+            file.write(reinterpret_cast<const char*>(&length), sizeof(length));
+            file.write(name.data(), static_cast<std::streamsize>(name.size()));
+        }
+        file.seekp(0);
+        writeHeader(dictionaryOffset, indexOffset, propertyNames.size());
+        file.close();
+        if (file.fail()) {
+            throw std::runtime_error("Writing the event file failed");
+        }
+    }
+
+    // Whether every write so far succeeded
+    [[nodiscard]] bool good() const {
+        return file.good();
+    }
+
+    [[nodiscard]] uint64_t getNumberOfRecords() const {
+        return numRecords;
+    }
+
+    [[nodiscard]] uint64_t getNumberOfWrites() const {
+        return writes;
+    }
+
+    // Get the number of bytes of encoded blocks written so far
+    [[nodiscard]] uint64_t getEncodedBytes() const {
+        return offset - sizeof(CompressedEventFileHeader);
+    }
+
+    // Get the memory the writer holds, the current block, its encoding and the index
+    [[nodiscard]] size_t getBufferBytes() const {
+        return block.capacity() * sizeof(EventRecord) + encoded.capacity() +
+               index.capacity() * sizeof(CompressedBlockEntry);
+    }
+};
+
+
+#endif //FUSION_COMPRESSED_EVENT_FILE_H
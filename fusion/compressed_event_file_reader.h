@@ -0,0 +1,215 @@
+//
+// Created by Tianjian Qin on 10/16/2026.
+// Class definition for the compressed event file reader, which maps a compressed event history file into memory and
+// decodes its blocks, on several threads when reading all of it
+//
+
+#ifndef FUSION_COMPRESSED_EVENT_FILE_READER_H
+#define FUSION_COMPRESSED_EVENT_FILE_READER_H
+
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include "compressed_event_file.h"
+#include "mapped_file.h"
+#include "work_stealing_pool.h"
+
+// Blocks are encoded independently and the index gives the offset of each, so any block decodes on its own: readAll()
+// hands groups of blocks to a work-stealing pool, each decoding straight into its slice of the result. Time range and
+// population queries rule out blocks by the ranges in the index and decode only the rest.
+// Queries only read the mapping and may run from several threads at once.
+class CompressedEventFileReader {
+private:
+    MappedFile file;
+    const unsigned char* data;                   // Contents of the file
+    size_t length;                               // Size of the file
+    CompressedEventFileHeader header{};
+    std::vector<CompressedBlockEntry> index;     // Block index
+    std::vector<size_t> firstRecords;            // Position of the first record of every block
+    std::vector<std::string> propertyNames;
+
+    [[noreturn]] static void fail(const std::string& path, const char* reason) {
+        throw std::runtime_error("Cannot read event file " + path + ": " + reason);
+    }
+
+    // Decode every block passing a test and call f(record) for its records in file order, returns the blocks decoded
+    template <typename Test, typename F>
+    size_t forEachInBlocks(Test&& test, F&& f) const {
+        size_t blocksRead = 0;
+        std::vector<EventRecord> records;
+        for (size_t block = 0; block < index.size(); ++block) {
+            if (!test(index[block])) {
+                continue;
+            }
+            ++blocksRead;
+            records.resize(index[block].numRecords);
+            decodeBlock(block, records.data());
+            for (const EventRecord& record : records) {
+                f(record);
+            }
+        }
+        return blocksRead;
+    }
+
+public:
+    // Map a completed compressed event file, throws if it cannot be read or is not a complete compressed event file
+    explicit CompressedEventFileReader(const std::string& path)
+            : file(path), data(file.getData()), length(file.size()) {
+        if (length < sizeof(CompressedEventFileHeader)) {
+            fail(path, "too short");
+        }
+        std::memcpy(&header, data, sizeof(header));
+        if (std::memcmp(header.magic, compressedEventFileMagic, sizeof(header.magic)) != 0) {
+            fail(path, "not a compressed event file");
+        }
+        if (header.version != compressedEventFileVersion ||
+            header.timeEncoding > static_cast<uint32_t>(TimeEncoding::Xor)) {
+            fail(path, "unsupported layout");
+        }
+        if (header.dictionaryOffset == 0) {
+            fail(path, "the file was not completed");
+        }
+        if (header.indexOffset > length || header.dictionaryOffset > length ||
+            header.numBlocks > (length - header.indexOffset) / sizeof(CompressedBlockEntry)) {
+            fail(path, "truncated");
+        }
+        index.resize(header.numBlocks);
+        if (header.numBlocks > 0) {
+            std::memcpy(index.data(), data + header.indexOffset, index.size() * sizeof(CompressedBlockEntry));
+        }
+        size_t position = 0;
+        for (const CompressedBlockEntry& entry : index) {
+            if (entry.offset < sizeof(CompressedEventFileHeader) || entry.offset > header.indexOffset ||
+                entry.bytes > header.indexOffset - entry.offset) {
+                fail(path, "truncated");
+            }
+            firstRecords.push_back(position);
+            position += entry.numRecords;
+        }
+        if (position != header.numRecords) {
+            fail(path, "the block index does not match the header");
+        }
+
+        size_t offset = header.dictionaryOffset;
+        for (uint32_t property = 0; property < header.numProperties; ++property) {
+            uint32_t nameLength;
+            if (offset + sizeof(nameLength) > length) {
+                fail(path, "truncated");
+            }
+            std::memcpy(&nameLength, data + offset, sizeof(nameLength));
+            offset += sizeof(nameLength);
+            if (offset + nameLength > length) {
+                fail(path, "truncated");
+            }
+            propertyNames.emplace_back(reinterpret_cast<const char*>(data + offset), nameLength);
+            offset += nameLength;
+        }
+    }
+
+    CompressedEventFileReader(const CompressedEventFileReader&) = delete;
+    CompressedEventFileReader& operator=(const CompressedEventFileReader&) = delete;
+
+    // Decode the records of a block into out, which must have room for them, throws if the block is malformed
+    void decodeBlock(size_t block, EventRecord* out) const {
+        const CompressedBlockEntry& entry = index.at(block);
+        decodeEventBlock(data + entry.offset, entry.bytes, entry.numRecords,
+                         static_cast<TimeEncoding>(header.timeEncoding), out);
+    }
+
+    // Decode every record, blocks spread over a number of threads, throws if a block is malformed
+    [[nodiscard]] std::vector<EventRecord> readAll(size_t numThreads = std::thread::hardware_concurrency()) const {
+        std::vector<EventRecord> records(header.numRecords);
+        numThreads = std::clamp<size_t>(numThreads, 1, std::max<size_t>(index.size(), 1));
+        if (numThreads == 1) {
+            for (size_t block = 0; block < index.size(); ++block) {
+                decodeBlock(block, records.data() + firstRecords[block]);
+            }
+            return records;
+        }
+
+        // A few tasks per thread so a thread held up by one slow block can be relieved of the rest
+        WorkStealingPool pool(numThreads);
+        size_t blocksPerTask = std::max<size_t>(index.size() / (numThreads * 4), 1);
+        for (size_t first = 0; first < index.size(); first += blocksPerTask) {
+            size_t last = std::min(first + blocksPerTask, index.size());
+            pool.submit([this, first, last, &records]() {
+                for (size_t block = first; block < last; ++block) {
+                    decodeBlock(block, records.data() + firstRecords[block]);
+                }
+            });
+        }
+        pool.run();
+        return records;
+    }
+
+    // Call f(record) for every record with a time in [from, to], in file order, returns the number of blocks decoded
+    template <typename F>
+    size_t forEachInTimeRange(double from, double to, F&& f) const {
+        return forEachInBlocks(
+                [from, to](const CompressedBlockEntry& entry) { return entry.maxTime >= from && entry.minTime <= to; },
+                [from, to, &f](const EventRecord& record) {
+                    if (record.time >= from && record.time <= to) {
+                        f(record);
+                    }
+                });
+    }
+
+    // Call f(record) for every record of a population, as a population or as a parent, in file order. Returns the
+    // number of blocks decoded. Negative ids, the -1 of unused fields, are left out of the block ranges and match
+    // nothing.
+    template <typename F>
+    size_t forEachOfPopulation(PopulationId id, F&& f) const {
+        return forEachInBlocks(
+                [id](const CompressedBlockEntry& entry) {
+                    return id >= entry.minPopulation && id <= entry.maxPopulation;
+                },
+                [id, &f](const EventRecord& record) {
+                    if (record.population == id || record.parent == id) {
+                        f(record);
+                    }
+                });
+    }
+
+    // Get every record with a time in [from, to]
+    [[nodiscard]] std::vector<EventRecord> getEventsBetween(double from, double to) const {
+        std::vector<EventRecord> events;
+        forEachInTimeRange(from, to, [&events](const EventRecord& record) { events.push_back(record); });
+        return events;
+    }
+
+    // Get every record of a population
+    [[nodiscard]] std::vector<EventRecord> getEventsOfPopulation(PopulationId id) const {
+        std::vector<EventRecord> events;
+        forEachOfPopulation(id, [&events](const EventRecord& record) { events.push_back(record); });
+        return events;
+    }
+
+    // Get the name of a mutated property from the index in a record
+    [[nodiscard]] const std::string& getPropertyName(int64_t property) const {
+        return propertyNames.at(static_cast<size_t>(property));
+    }
+
+    [[nodiscard]] TimeEncoding getTimeEncoding() const {
+        return static_cast<TimeEncoding>(header.timeEncoding);
+    }
+
+    [[nodiscard]] size_t size() const {
+        return header.numRecords;
+    }
+
+    [[nodiscard]] size_t getNumberOfBlocks() const {
+        return index.size();
+    }
+
+    [[nodiscard]] size_t getFileBytes() const {
+        return length;
+    }
+};
+
+
+#endif //FUSION_COMPRESSED_EVENT_FILE_READER_H
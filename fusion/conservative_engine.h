@@ -0,0 +1,258 @@
+//
+// Created by Tianjian Qin on 10/16/2026.
+// Class definition for the conservative engine, which simulates the islands of one system in parallel without ever
+// rolling back
+//
+
+#ifndef FUSION_CONSERVATIVE_ENGINE_H
+#define FUSION_CONSERVATIVE_ENGINE_H
+
+
+#include <algorithm>
+#include <atomic>
+#include <barrier>
+#include <chrono>
+#include <cstdint>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "island_engine.h"
+
+// Tuning of the conservative engine
+struct ConservativeSettings {
+    size_t numThreads = std::thread::hardware_concurrency(); // Number of worker threads, at most one per island
+    PopulationId idBlockSize = 4096;        // Ids an island reserves at a time
+};
+
+// Time a worker spent stepping its islands and waiting for the others
+struct ConservativeWorkerStatistics {
+    size_t islands = 0;                     // Number of islands owned
+    uint64_t steps = 0;                     // Events and messages handled
+    double busySeconds = 0.0;               // Wall-clock time spent stepping and taking messages in
+    double blockedSeconds = 0.0;            // Wall-clock time spent waiting at the end of rounds
+};
+
+// Statistics of a conservative run
+struct ConservativeStatistics {
+    size_t numThreads = 0;                  // Number of worker threads used
+    size_t rounds = 0;                      // Number of synchronization rounds
+    uint64_t committedSteps = 0;            // Events and messages handled, nothing is ever undone
+    uint64_t criticalSteps = 0;             // Sum over rounds of the most steps one worker took
+    double parallelism = 0.0;               // Committed over critical steps, the speedup the partitioning allows
+    double activeIslands = 0.0;             // Islands advancing in an average round
+    double wallSeconds = 0.0;               // Wall-clock time of the run
+    std::vector<ConservativeWorkerStatistics> workers;
+};
+
+// Every island is a logical process owned by one worker thread, like in the Time Warp engine, but an island only takes
+// steps no message can reach any more (YAWNS-style windows). Rounds start with a safe horizon for every island, derived
+// from the earliest time any island may send:
+// - an island sends at its next local event if some barrier of it is below 1, at its next barrier change, or after a
+//   message it has not handled yet;
+// - towards an island behind a barrier of 1 it sends nothing before one of the two changes that barrier, with a
+//   barrier change message already waiting or at their next barrier change times, which are drawn ahead;
+// - messages pass on what they trigger, so the bounds spread along the coupling graph (shortest paths, O(I^2) a round).
+// Workers step their islands up to the horizons, messages they send are taken in after the round. Islands walled off
+// from everything advance freely up to the next barrier change, tightly coupled ones a few events a round.
+// Results only depend on the seed and are those of the Time Warp engine with the same seed.
+class ConservativeEngine : private IslandEngine {
+private:
+    ConservativeSettings settings;
+    std::vector<double> horizons;                               // Time up to which each island may step this round
+    std::vector<double> sendBounds;                             // Earliest time each island may send anything
+    std::vector<char> settled;                                  // Whether the send bound of an island is final
+
+    // Earliest time an island may send to another, given the earliest time it may send at all: its next barrier change,
+    // or an emigrant once the barrier between them is below 1 (which the receiver's next barrier change also does)
+    [[nodiscard]] double edgeBound(int sender, int receiver, double senderBound) const {
+        const IslandProcess& from = *processes[sender];
+        double coupled = std::min(from.couplingTime(receiver), processes[receiver]->getNextBarrierChangeTime());
+        return std::min(from.getNextBarrierChangeTime(), std::max(senderBound, coupled));
+    }
+
+    // Compute the horizon of every island, Dijkstra over the dense coupling graph as bounds only grow along edges
+    void computeHorizons() {
+        int n = model.numIslands;
+        for (int island = 0; island < n; ++island) {
+            sendBounds[island] = processes[island]->earliestSend();
+            settled[island] = 0;
+        }
+        for (int round = 0; round < n; ++round) {
+            int next = -1;
+            for (int island = 0; island < n; ++island) {
+                if (!settled[island] && (next < 0 || sendBounds[island] < sendBounds[next])) {
+                    next = island;
+                }
+            }
+            settled[next] = 1;
+            for (int island = 0; island < n; ++island) {
+                if (!settled[island]) {
+                    sendBounds[island] = std::min(sendBounds[island], edgeBound(next, island, sendBounds[next]));
+                }
+            }
+        }
+
+        // Messages an island triggers itself come back strictly later, so it may step up to and including its horizon
+        for (int island = 0; island < n; ++island) {
+            double horizon = IslandProcess::never;
+            for (int sender = 0; sender < n; ++sender) {
+                if (sender != island) {
+                    horizon = std::min(horizon, edgeBound(sender, island, sendBounds[sender]));
+                }
+            }
+            horizons[island] = horizon;
+        }
+    }
+
+    // Whether every island is done with the time span
+    [[nodiscard]] bool allReached(double maxTime) const {
+        return std::all_of(processes.begin(), processes.end(),
+                           [maxTime](const auto& process) { return process->nextTime() >= maxTime; });
+    }
+
+public:
+    // Constructor
+    ConservativeEngine(System& sys, Observer& obs, const RandomService& randomService, double birthRate,
+                       double deathRate, const ConservativeSettings& engineSettings = {})
+            : IslandEngine(sys, obs, randomService, birthRate, deathRate, engineSettings.idBlockSize),
+              settings(engineSettings) {}
+
+    // Simulate the system up to a time, afterwards the system holds the final state and the observer the history
+    ConservativeStatistics run(double maxTime) {
+        ConservativeStatistics statistics;
+        auto start = std::chrono::steady_clock::now();
+        bool wasVerbose = System::isVerbose();
+        System::setVerbose(false);
+
+        // Islands continue from the current state of the system and never save states
+        size_t numWorkers = startProcesses(settings.numThreads, 0);
+        statistics.numThreads = numWorkers;
+        statistics.workers.assign(numWorkers, {});
+        for (size_t worker = 0; worker < numWorkers; ++worker) {
+            statistics.workers[worker].islands = islandsOfWorker[worker].size();
+        }
+        horizons.assign(model.numIslands, 0.0);
+        sendBounds.assign(model.numIslands, 0.0);
+        settled.assign(model.numIslands, 0);
+        computeHorizons();
+
+        // Shared round state, only written by the barrier's completion step while every worker waits
+        std::vector<uint64_t> roundSteps(numWorkers, 0);
+        std::vector<size_t> roundActive(numWorkers, 0);
+        uint64_t activeIslands = 0;
+        bool draining = false;
+        bool finished = allReached(maxTime);
+        std::atomic<bool> failed{false};
+        std::exception_ptr failure;
+        std::mutex failureMutex;
+
+        // Rounds have two phases, stepping and taking the messages of the step phase in
+        auto completePhase = [&]() noexcept {
+            if (!draining) {
+                draining = true;
+                ++statistics.rounds;
+                statistics.criticalSteps += *std::max_element(roundSteps.begin(), roundSteps.end());
+                for (size_t active : roundActive) {
+                    activeIslands += active;
+                }
+                return;
+            }
+            draining = false;
+            if (failed.load(std::memory_order_relaxed)) {
+                finished = true;
+                return;
+            }
+            computeHorizons();
+            finished = allReached(maxTime);
+        };
+        std::barrier sync(static_cast<std::ptrdiff_t>(numWorkers), completePhase);
+
+        auto record = [&]() {
+            std::lock_guard<std::mutex> lock(failureMutex);
+            if (!failure) {
+                failure = std::current_exception();
+            }
+            failed.store(true, std::memory_order_relaxed);
+        };
+
+        auto work = [&](size_t worker) {
+            using Clock = std::chrono::steady_clock;
+            ConservativeWorkerStatistics& own = statistics.workers[worker];
+            while (!finished) {
+                auto stepStart = Clock::now();
+                roundSteps[worker] = 0;
+                roundActive[worker] = 0;
+                try {
+                    if (!failed.load(std::memory_order_relaxed)) {
+                        for (int island : islandsOfWorker[worker]) {
+                            IslandProcess& process = *processes[island];
+                            double limit = horizons[island];
+                            uint64_t steps = 0;
+                            while (process.nextTime() <= limit && process.nextTime() < maxTime) {
+                                process.step();
+                                flush(process);
+                                ++steps;
+                            }
+                            roundSteps[worker] += steps;
+                            roundActive[worker] += steps > 0;
+                        }
+                    }
+                } catch (...) {
+                    record();
+                }
+                auto stepEnd = Clock::now();
+                sync.arrive_and_wait();
+
+                auto drainStart = Clock::now();
+                try {
+                    if (!failed.load(std::memory_order_relaxed)) {
+                        drain(worker);
+                        for (int island : islandsOfWorker[worker]) {
+                            processes[island]->collectFossils(processes[island]->getTime());
+                        }
+                    }
+                } catch (...) {
+                    record();
+                }
+                auto drainEnd = Clock::now();
+                sync.arrive_and_wait();
+
+                own.steps += roundSteps[worker];
+                own.busySeconds += std::chrono::duration<double>((stepEnd - stepStart) + (drainEnd - drainStart)).count();
+                own.blockedSeconds += std::chrono::duration<double>((drainStart - stepEnd) + (Clock::now() - drainEnd)).count();
+            }
+        };
+
+        std::vector<std::thread> workers;
+        for (size_t worker = 1; worker < numWorkers; ++worker) {
+            workers.emplace_back(work, worker);
+        }
+        work(0);
+        for (auto& thread : workers) {
+            thread.join();
+        }
+
+        discardInFlight();
+        if (failure) {
+            System::setVerbose(wasVerbose);
+            std::rethrow_exception(failure);
+        }
+
+        statistics.committedSteps = finishProcesses();
+        if (statistics.criticalSteps > 0) {
+            statistics.parallelism = static_cast<double>(statistics.committedSteps) /
+                                     static_cast<double>(statistics.criticalSteps);
+        }
+        if (statistics.rounds > 0) {
+            statistics.activeIslands = static_cast<double>(activeIslands) / static_cast<double>(statistics.rounds);
+        }
+        System::setVerbose(wasVerbose);
+
+        statistics.wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        return statistics;
+    }
+};
+
+
+#endif //FUSION_CONSERVATIVE_ENGINE_H
@@ -7,6 +7,7 @@
 #define FUSION_DIRECTOR_H
 
 
+#include <algorithm>
 #include <random>
 #include <iostream>
 #include "unit_population.h"
@@ -14,6 +15,17 @@
 #include "event.h"
 #include "system.h"
 #include "observer.h"
+#include "rate_store.h"
+#include "event_selector.h"
+#include "sum_tree_selector.h"
+#include "composition_rejection_selector.h"
+#include "next_reaction_selector.h"
+#include "hierarchical_selector.h"
+#include "tau_leaping.h"
+#include "random_service.h"
+#include "niche_kernel.h"
+#include "time_warp.h"
+#include "conservative_engine.h"
 
 class Director {
 private:
@@ -21,145 +33,416 @@ private:
     double baseBirthRate;                        // Base birth rate (used for population events)
     double baseDeathRate;                        // Base death rate (used for population events)
     Observer observer;                           // Observer to record events
-    std::vector<std::pair<int, PopulationEvent*>> populationEvents; // List of population events with corresponding rates
-    std::vector<std::pair<int, IsolationEvent*>> isolationEvents;   // List of isolation events with corresponding rates
-    std::random_device rd;                       // Random device for seeding random number generator
-    std::mt19937 gen;                            // Random number generator
+    RandomService random;                        // Source of all random streams of this run
+    RandomStream selectionRandom;                // Stream for waiting times and event selection
+    RandomStream eventRandom;                    // Stream for choices made while executing events
+    RandomStream leapRandom;                     // Stream for the tau-leaping mode
+    EventRateStore rateStore;                    // All possible events with their rates, updated incrementally
+    bool nicheCompetition = false;               // Whether birth and death rates depend on niche saturation
+    NicheCompetitionKernel nicheKernel;          // Occupancy and competition rates per island
+    std::vector<double> occupancyBuffer;         // Kernel outputs, reused between calls
+    std::vector<double> birthRateBuffer;
+    std::vector<double> deathRateBuffer;
+    std::vector<uint64_t> leapBits;              // Random bits of the picks within one leap, drawn in bulk
 
 public:
+    // Create the selection engine for a sampling method
+    static std::unique_ptr<EventSelector> makeSelector(SamplingMethod method, const RandomStream& firingTimeStream) {
+        switch (method) {
+            case SamplingMethod::SumTree:
+                return std::make_unique<SumTreeSelector>();
+            case SamplingMethod::CompositionRejection:
+                return std::make_unique<CompositionRejectionSelector>();
+            case SamplingMethod::NextReaction:
+                return std::make_unique<NextReactionSelector>(firingTimeStream);
+            case SamplingMethod::Hierarchical:
+                return std::make_unique<HierarchicalSelector>();
+            case SamplingMethod::Direct:
+            default:
+                return std::make_unique<DirectSelector>();
+        }
+    }
+
     // Constructor to initialize the system and rates
-    Director(int numIsolations, double birthRate, double deathRate)
+    // A run is bit-reproducible from its seed and replicate index
+    Director(int numIsolations, double birthRate, double deathRate, SamplingMethod method = SamplingMethod::Direct,
+             uint64_t seed = std::random_device{}(), uint32_t replicate = 0)
             : system(numIsolations, birthRate, deathRate),
-              baseBirthRate(birthRate), baseDeathRate(deathRate), gen(rd()) {}
+              baseBirthRate(birthRate), baseDeathRate(deathRate),
+              random(seed, replicate),
+              selectionRandom(random.stream(SelectionStream)),
+              eventRandom(random.stream(EventStream)),
+              leapRandom(random.stream(LeapStream)),
+              rateStore(system, birthRate, deathRate, makeSelector(method, random.stream(FiringTimeStream))) {}
+
+    // Get the observer holding the event history
+    [[nodiscard]] const Observer& getObserver() const {
+        return observer;
+    }
+
+    // Get the simulated system
+    [[nodiscard]] const System& getSystem() const {
+        return system;
+    }
+
+    // Write the event history to a file while simulating instead of keeping it in memory, the file is completed when a
+    // run method ends or on closeEventStream()
+    void streamEvents(const std::string& path, const EventStreamSettings& settings = {}) {
+        observer.streamTo(path, settings);
+    }
+
+    // Complete the file the event history is streamed to
+    EventStreamStatistics closeEventStream() {
+        return observer.closeStream();
+    }
+
+    // Print the history for review, or complete the file it is streamed to and summarize it
+    void reportEventHistory() {
+        if (!observer.isStreaming()) {
+            observer.printEventHistory();
+            return;
+        }
+        EventStreamStatistics statistics = observer.closeStream();
+        std::cout << "Event stream closed with " << statistics.written << " records in " << statistics.writes
+                  << " writes, " << statistics.dropped << " dropped and " << statistics.sampledOut
+                  << " sampled out.\n";
+    }
+
+    // Switch density-dependent rates on or off, set before the simulation starts. Only exact stepping uses them,
+    // tau-leaping keeps drawing at the base rates.
+    void setNicheCompetition(bool enabled) {
+        nicheCompetition = enabled;
+    }
+
+    // Get the kernel computing niche competition, e.g. to opt into a vector instruction set (scalar by default)
+    [[nodiscard]] NicheCompetitionKernel& getNicheKernel() {
+        return nicheKernel;
+    }
 
-    // Method to compute the rate for each event
+    // Method to build the rate store from scratch, after this it is only updated incrementally
     void computeEventRates() {
-        // Clear previous events
-        populationEvents.clear();
-        isolationEvents.clear();
-
-        // Loop over all isolations
-        for (int isolationIndex = 0; isolationIndex < system.getNumberOfIsolations(); ++isolationIndex) {
-            auto isolation = system.getIsolation(isolationIndex); // Use shared_ptr
-
-            // For each population in the isolation, compute birth and death event rates
-            const std::vector<UnitPopulation>& populations = isolation->getUnitPopulations();
-            for (const UnitPopulation& population : populations) {
-                // Birth event
-                auto birthEvent = std::make_shared<PopulationBirthEvent>(&population, isolation, baseBirthRate);
-                populationEvents.emplace_back(baseBirthRate, birthEvent.get());
-
-                // Death event
-                auto deathEvent = std::make_shared<PopulationDeathEvent>(&population, isolation);
-                populationEvents.emplace_back(baseDeathRate, deathEvent.get());
-
-                // Immigration events (considering barriers)
-                for (int targetIsolationIndex = 0; targetIsolationIndex < system.getNumberOfIsolations(); ++targetIsolationIndex) {
-                    if (isolationIndex != targetIsolationIndex) {
-                        double barrier = system.getBarrierThreshold(isolationIndex, targetIsolationIndex);
-                        if (barrier < 1.0) {
-                            auto targetIsolation = system.getIsolation(targetIsolationIndex); // Use shared_ptr
-
-                            auto immigrationEvent = std::make_shared<PopulationImmigrationEvent>(
-                                    &population, isolation, targetIsolation, baseBirthRate
-                            );
-                            populationEvents.emplace_back(baseBirthRate * (1.0 - barrier), immigrationEvent.get());
-                        }
-                    }
+        rateStore.rebuild();
+        if (nicheCompetition) {
+            for (int i = 0; i < static_cast<int>(system.getNumberOfIsolations()); ++i) {
+                refreshNicheCompetition(i);
+            }
+        }
+    }
+
+    // Reserve room for a number of living populations and logged events, so that exact steps within them do not
+    // allocate. Call after computeEventRates(), which rebuilds the rate store.
+    void reserve(size_t numPopulations, size_t numEvents) {
+        for (const auto& isolation : system.getAllIsolations()) {
+            isolation->getPopulationStore().reserve(numPopulations);
+            occupancyBuffer.reserve(isolation->getNicheSpaces().getNumberOfDimensions());
+        }
+        rateStore.reserve(numPopulations);
+        observer.reserveHistory(numEvents);
+        birthRateBuffer.reserve(numPopulations);
+        deathRateBuffer.reserve(numPopulations);
+    }
+
+    // Method to recompute the niche occupancy of an island and the competition-scaled rates of everyone on it
+    void refreshNicheCompetition(int isolationIndex) {
+        auto isolation = system.getIsolation(isolationIndex);
+        const PopulationStore& populations = isolation->getUnitPopulations();
+        occupancyBuffer.resize(populations.getNumberOfNiches());
+        birthRateBuffer.resize(populations.size());
+        deathRateBuffer.resize(populations.size());
+
+        nicheKernel.run(populations.getResourceUse(), populations.size(), populations.getNumberOfNiches(),
+                        isolation->getNicheSpaces().getAvailableSpaces(), baseBirthRate, baseDeathRate,
+                        occupancyBuffer, birthRateBuffer, deathRateBuffer);
+        isolation->setNicheOccupancy(occupancyBuffer);
+        rateStore.setPopulationRates(isolationIndex, birthRateBuffer, deathRateBuffer);
+    }
+
+    // Method to sample the time for the next event and the event itself
+    std::pair<double, const EventDescriptor*> sampleNextEvent() {
+        auto [waitingTime, index] = rateStore.getSelector().sampleNext(selectionRandom);
+        if (index == EventSelector::npos) {
+            return {waitingTime, nullptr};
+        }
+        return {waitingTime, &rateStore.getDescriptors()[index]};
+    }
+
+    // Methods to log an executed event to the observer, one overload per event type
+    void logEvent(double currentTime, const PopulationBirthEvent& birthEvent) {
+        observer.logBirthEvent(currentTime, birthEvent.getParentId(), birthEvent.getChildId(), birthEvent.getLocationId());
+    }
+
+    void logEvent(double currentTime, const PopulationDeathEvent& deathEvent) {
+        observer.logDeathEvent(currentTime, deathEvent.getPopulationId());
+    }
+
+    void logEvent(double currentTime, const PopulationImmigrationEvent& immigrationEvent) {
+        observer.logImmigrationEvent(currentTime, immigrationEvent.getPopulationId(), immigrationEvent.getChildId(),
+                                     immigrationEvent.getFromLocation(), immigrationEvent.getToLocation());
+    }
+
+    void logEvent(double currentTime, const PopulationMutationEvent& mutationEvent) {
+        observer.logMutationEvent(currentTime, mutationEvent.getPopulationId(), mutationEvent.getLocationId(),
+                                  mutationEvent.getMutatedProperty(), mutationEvent.getOldValue(), mutationEvent.getNewValue());
+    }
+
+    // Isolation events are not part of the history
+    void logEvent(double, const ResourceAvailabilityChangeEvent&) {}
+    void logEvent(double, const BarrierThresholdChangeEvent&) {}
+
+    // Method to execute an event of a known type and log it
+    template <typename ConcreteEvent>
+    void executeEvent(double currentTime, ConcreteEvent& event) {
+        event.execute(); // Execute event before logging, children get their id on execution
+        logEvent(currentTime, event);
+    }
+
+    // Method to fire the event a descriptor stands for and update the rates it touched. A single switch over the kind
+    // resolves execution, logging and the rate update, the event object only lives on the stack for this call.
+    // The descriptor is taken by value as the rate store may move or drop it while updating.
+    void fireEvent(double currentTime, EventDescriptor descriptor) {
+        auto isolation = system.getIsolation(descriptor.sourceIsolation);
+        switch (descriptor.kind) {
+            case EventKind::Birth: {
+                PopulationBirthEvent birthEvent(rateStore.getPopulationId(descriptor.populationSlot),
+                                                rateStore.getPopulationHandle(descriptor.populationSlot), isolation, system,
+                                                eventRandom, baseBirthRate);
+                executeEvent(currentTime, birthEvent);
+                rateStore.addPopulation(birthEvent.getLocationId(), birthEvent.getChildHandle());
+                if (nicheCompetition) {
+                    refreshNicheCompetition(birthEvent.getLocationId());
+                }
+                break;
+            }
+            case EventKind::Death: {
+                PopulationDeathEvent deathEvent(rateStore.getPopulationId(descriptor.populationSlot),
+                                                rateStore.getPopulationHandle(descriptor.populationSlot), isolation);
+                executeEvent(currentTime, deathEvent);
+                rateStore.removePopulation(descriptor.populationSlot);
+                if (nicheCompetition) {
+                    refreshNicheCompetition(descriptor.sourceIsolation);
+                }
+                break;
+            }
+            case EventKind::Immigration: {
+                PopulationImmigrationEvent immigrationEvent(rateStore.getPopulationId(descriptor.populationSlot),
+                                                            rateStore.getPopulationHandle(descriptor.populationSlot),
+                                                            isolation, system, eventRandom, baseBirthRate);
+                executeEvent(currentTime, immigrationEvent);
+                rateStore.addPopulation(immigrationEvent.getToLocation(), immigrationEvent.getChildHandle());
+                if (nicheCompetition) {
+                    refreshNicheCompetition(immigrationEvent.getToLocation());
+                }
+                break;
+            }
+            case EventKind::ResourceChange: {
+                ResourceAvailabilityChangeEvent resourceEvent(isolation, rateStore.getResourceTarget(descriptor.sourceIsolation));
+                executeEvent(currentTime, resourceEvent);
+                if (nicheCompetition) {
+                    refreshNicheCompetition(descriptor.sourceIsolation); // Availability only enters competition rates
                 }
+                break;
+            }
+            case EventKind::BarrierChange: {
+                BarrierThresholdChangeEvent barrierEvent(isolation, system, rateStore.getBarrierTarget(descriptor.sourceIsolation));
+                executeEvent(currentTime, barrierEvent);
+                rateStore.refreshIsolationBarriers(barrierEvent.getChangedIsolations());
+                break;
             }
+        }
+    }
+
+    // Method to take one exact step, returns the time after the step
+    double stepExact(double currentTime, double maxTime) {
+        // Sample the next event and the waiting time for it
+        auto [waitingTime, nextEvent] = sampleNextEvent();
 
-            // Isolation resource change event (as an example)
-            auto resourceChangeEvent = std::make_shared<ResourceAvailabilityChangeEvent>(
-                    isolation, std::vector<double>{10.0, 10.0, 10.0} // Just an example
-            );
-            isolationEvents.emplace_back(0.1, resourceChangeEvent.get()); // Assuming a small probability for resource change
+        // Update time
+        currentTime += waitingTime;
 
-            // Barrier threshold change event
-            auto barrierChangeEvent = std::make_shared<BarrierThresholdChangeEvent>(isolation, 0.5); // Example change
-            isolationEvents.emplace_back(0.05, barrierChangeEvent.get()); // Assuming a smaller chance for barrier change
+        // Execute the next event and log it to the observer
+        if (nextEvent && currentTime < maxTime) {
+            fireEvent(currentTime, *nextEvent);
         }
+        return currentTime;
     }
 
+    // Method to run the simulation without printing anything at the end
+    void simulate(double maxTime) {
+        double currentTime = 0.0;
+
+        // Compute event rates for the initial system state
+        computeEventRates();
 
-    // Method to sample the time for the next event and the event itself
-    std::pair<double, Event*> sampleNextEvent() {
-        // Compute total rate for all events
-        double totalRate = 0.0;
-        for (const auto& eventPair : populationEvents) {
-            totalRate += eventPair.first;
+        // Main simulation loop
+        while (currentTime < maxTime) {
+            currentTime = stepExact(currentTime, maxTime);
         }
-        for (const auto& eventPair : isolationEvents) {
-            totalRate += eventPair.first;
+    }
+
+    // Method to run the simulation
+    void runSimulation(double maxTime) {
+        simulate(maxTime);
+
+        // After simulation, print the history for review
+        reportEventHistory();
+    }
+
+    // Method to fire Poisson-distributed numbers of every event class within one leap, returns the number of events
+    size_t leap(double leapEndTime, double tau) {
+        size_t firedEvents = 0;
+        auto poisson = [this](double mean) -> size_t {
+            return mean > 0.0 ? std::poisson_distribution<size_t>(mean)(leapRandom) : 0;
+        };
+
+        // Rates are frozen over the leap, so parents and victims are drawn from the population slots at its start
+        int numIsolations = static_cast<int>(system.getNumberOfIsolations());
+        std::vector<std::vector<int>> residents(numIsolations);
+        const auto& slots = rateStore.getPopulationSlots();
+        for (size_t slot = 0; slot < slots.size(); ++slot) {
+            if (slots[slot].populationId >= 0) {
+                residents[slots[slot].isolation].push_back(static_cast<int>(slot));
+            }
         }
 
-        // Sample the waiting time for the next event (exponentially distributed)
-        std::exponential_distribution<> expDist(totalRate);
-        double waitingTime = expDist(gen);
+        // Births and immigrations
+        for (int i = 0; i < numIsolations; ++i) {
+            if (residents[i].empty()) {
+                continue;
+            }
+            double count = static_cast<double>(residents[i].size());
+
+            size_t births = poisson(baseBirthRate * count * tau);
+            leapBits.resize(births);
+            leapRandom.fill64(leapBits.data(), births);
+            for (size_t k = 0; k < births; ++k) {
+                int parentSlot = residents[i][RandomStream::toIndex(leapBits[k], residents[i].size())];
+                fireEvent(leapEndTime, {EventKind::Birth, parentSlot, i, -1, baseBirthRate});
+            }
+            firedEvents += births;
+
+            size_t immigrations = poisson(baseBirthRate * system.getEmigrationWeight(i) * count * tau);
+            leapBits.resize(immigrations);
+            leapRandom.fill64(leapBits.data(), immigrations);
+            for (size_t k = 0; k < immigrations; ++k) {
+                int parentSlot = residents[i][RandomStream::toIndex(leapBits[k], residents[i].size())];
+                fireEvent(leapEndTime, {EventKind::Immigration, parentSlot, i, -1, baseBirthRate});
+            }
+            firedEvents += immigrations;
+        }
 
-        // Sample which event happens (based on their relative rates)
-        std::uniform_real_distribution<> uniformDist(0.0, totalRate);
-        double threshold = uniformDist(gen);
+        // Deaths come last so every parent above was still alive, and nobody dies twice
+        for (int i = 0; i < numIsolations; ++i) {
+            auto& victims = residents[i];
+            size_t deaths = std::min(poisson(baseDeathRate * static_cast<double>(victims.size()) * tau), victims.size());
+            leapBits.resize(deaths);
+            leapRandom.fill64(leapBits.data(), deaths);
+            for (size_t k = 0; k < deaths; ++k) {
+                std::swap(victims[k], victims[k + RandomStream::toIndex(leapBits[k], victims.size() - k)]);
+                fireEvent(leapEndTime, {EventKind::Death, victims[k], i, -1, baseDeathRate});
+            }
+            firedEvents += deaths;
+        }
 
-        // Select event based on threshold
-        double cumulativeRate = 0.0;
-        for (const auto& eventPair : populationEvents) {
-            cumulativeRate += eventPair.first;
-            if (cumulativeRate >= threshold) {
-                return {waitingTime, eventPair.second};
+        // Isolation events, collected first as firing a barrier change updates rates while we would be iterating
+        std::vector<EventDescriptor> isolationEvents;
+        for (const EventDescriptor& descriptor : rateStore.getDescriptors()) {
+            if (descriptor.kind == EventKind::ResourceChange || descriptor.kind == EventKind::BarrierChange) {
+                isolationEvents.push_back(descriptor);
             }
         }
-        for (const auto& eventPair : isolationEvents) {
-            cumulativeRate += eventPair.first;
-            if (cumulativeRate >= threshold) {
-                return {waitingTime, eventPair.second};
+        for (const EventDescriptor& descriptor : isolationEvents) {
+            size_t occurrences = poisson(descriptor.rate * tau);
+            for (size_t k = 0; k < occurrences; ++k) {
+                fireEvent(leapEndTime, descriptor);
             }
+            firedEvents += occurrences;
         }
 
-        return {waitingTime, nullptr}; // Shouldn't reach here
+        return firedEvents;
     }
 
-    // Method to run the simulation
-    void runSimulation(double maxTime) {
+    // Method to run the simulation in approximate tau-leaping mode, falling back to exact steps while islands are small
+    TauLeapStatistics runTauLeaping(double maxTime, const TauLeapSettings& settings = {}) {
+        TauLeapStatistics statistics;
         double currentTime = 0.0;
 
-        // Main simulation loop
+        // Compute event rates for the initial system state
+        computeEventRates();
+
+        int numIsolations = static_cast<int>(system.getNumberOfIsolations());
+        std::vector<size_t> populationCounts(numIsolations);
         while (currentTime < maxTime) {
-            // Compute event rates for the current system state
-            computeEventRates();
-
-            // Sample the next event and the waiting time for it
-            auto [waitingTime, nextEvent] = sampleNextEvent();
-
-            // Update time
-            currentTime += waitingTime;
-
-            // Execute the next event and log it to the observer
-            if (nextEvent) {
-                if (dynamic_cast<PopulationBirthEvent*>(nextEvent)) {
-                    auto* birthEvent = dynamic_cast<PopulationBirthEvent*>(nextEvent);
-                    observer.logBirthEvent(currentTime, birthEvent->getParentId(), birthEvent->getChildId(), birthEvent->getLocationId());
-                } else if (dynamic_cast<PopulationDeathEvent*>(nextEvent)) {
-                    auto* deathEvent = dynamic_cast<PopulationDeathEvent*>(nextEvent);
-                    observer.logDeathEvent(currentTime, deathEvent->getPopulationId());
-                } else if (dynamic_cast<PopulationImmigrationEvent*>(nextEvent)) {
-                    auto* immigrationEvent = dynamic_cast<PopulationImmigrationEvent*>(nextEvent);
-                    observer.logImmigrationEvent(currentTime, immigrationEvent->getPopulationId(), immigrationEvent->getFromLocation(), immigrationEvent->getToLocation());
-                } else if (dynamic_cast<PopulationMutationEvent*>(nextEvent)) {
-                    auto* mutationEvent = dynamic_cast<PopulationMutationEvent*>(nextEvent);
-                    observer.logMutationEvent(currentTime, mutationEvent->getPopulationId(), mutationEvent->getLocationId(),
-                                              mutationEvent->getMutatedProperty(), mutationEvent->getOldValue(), mutationEvent->getNewValue());
-                }
+            bool critical = false;
+            for (int i = 0; i < numIsolations; ++i) {
+                populationCounts[i] = system.getIsolation(i)->getUnitPopulations().size();
+                critical = critical || (populationCounts[i] > 0 && populationCounts[i] < settings.criticalPopulationSize);
+            }
 
-                nextEvent->execute(); // Execute event after logging
+            double tau = critical ? 0.0 : selectTauLeapSize(system, populationCounts, baseBirthRate, baseDeathRate, settings.epsilon);
+            if (tau * rateStore.getSelector().getTotalRate() < settings.minLeapInEvents) {
+                // Small islands or a leap too short to pay off, take exact steps for a while
+                for (size_t step = 0; step < settings.exactStepsPerFallback && currentTime < maxTime; ++step) {
+                    currentTime = stepExact(currentTime, maxTime);
+                    ++statistics.exactSteps;
+                }
+                continue;
             }
 
-            // Clean up memory (dynamic events)
-            delete nextEvent;
+            tau = std::min(tau, maxTime - currentTime);
+            currentTime += tau;
+            statistics.leapedEvents += leap(currentTime, tau);
+            ++statistics.leaps;
         }
 
         // After simulation, print the history for review
-        observer.printEventHistory();
+        reportEventHistory();
+        std::cout << "Tau-leaping finished with " << statistics.leaps << " leaps (" << statistics.leapedEvents
+                  << " events) and " << statistics.exactSteps << " exact steps.\n";
+        return statistics;
+    }
+
+    // Method to simulate on all cores, islands are spread over worker threads that synchronize optimistically. The rate
+    // store is not kept up to date, so exact stepping afterwards has to start with computeEventRates().
+    TimeWarpStatistics simulateTimeWarp(double maxTime, const TimeWarpSettings& settings = {}) {
+        TimeWarpEngine engine(system, observer, random, baseBirthRate, baseDeathRate, settings);
+        return engine.run(maxTime);
+    }
+
+    // Method to run the simulation with the Time Warp engine and report on it
+    TimeWarpStatistics runTimeWarp(double maxTime, const TimeWarpSettings& settings = {}) {
+        TimeWarpStatistics statistics = simulateTimeWarp(maxTime, settings);
+
+        // After simulation, print the history for review
+        reportEventHistory();
+        std::cout << "Time Warp finished on " << statistics.numThreads << " threads with " << statistics.committedSteps
+                  << " committed steps, " << statistics.rollbacks << " rollbacks (" << statistics.rolledBackSteps
+                  << " steps undone) and " << statistics.antiMessages << " anti-messages over " << statistics.windows
+                  << " windows.\n";
+        return statistics;
+    }
+
+    // Method to simulate on all cores without rollbacks, islands only advance as far as no message can reach them. Like
+    // simulateTimeWarp() it leaves the rate store behind, and the same seed gives the same results.
+    ConservativeStatistics simulateConservative(double maxTime, const ConservativeSettings& settings = {}) {
+        ConservativeEngine engine(system, observer, random, baseBirthRate, baseDeathRate, settings);
+        return engine.run(maxTime);
+    }
+
+    // Method to run the simulation with the conservative engine and report on it, per worker to tune the partitioning
+    ConservativeStatistics runConservative(double maxTime, const ConservativeSettings& settings = {}) {
+        ConservativeStatistics statistics = simulateConservative(maxTime, settings);
+
+        // After simulation, print the history for review
+        reportEventHistory();
+        std::cout << "Conservative run finished on " << statistics.numThreads << " threads with "
+                  << statistics.committedSteps << " steps in " << statistics.rounds << " rounds, parallelism "
+                  << statistics.parallelism << " (" << statistics.activeIslands << " islands active per round).\n";
+        for (size_t worker = 0; worker < statistics.workers.size(); ++worker) {
+            const ConservativeWorkerStatistics& own = statistics.workers[worker];
+            std::cout << "Worker " << worker << ": " << own.islands << " islands, " << own.steps << " steps, "
+                      << own.busySeconds << " s busy, " << own.blockedSeconds << " s blocked.\n";
+        }
+        return statistics;
     }
 };
 
@@ -0,0 +1,109 @@
+//
+// Created by Tianjian Qin on 10/16/2026.
+// Class definition for the ensemble runner, which runs many independent replicates of one setup in parallel
+//
+
+#ifndef FUSION_ENSEMBLE_H
+#define FUSION_ENSEMBLE_H
+
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "director.h"
+#include "observer.h"
+#include "work_stealing_pool.h"
+
+// Setup shared by all replicates of an ensemble
+struct EnsembleSettings {
+    int numIsolations = 3;                                  // Number of isolations in every replicate
+    double birthRate = 0.5;                                 // Base birth rate
+    double deathRate = 0.2;                                 // Base death rate
+    double maxTime = 10.0;                                  // Simulated time per replicate
+    size_t numReplicates = 1;                               // Number of replicates
+    SamplingMethod method = SamplingMethod::Direct;         // Event selection engine
+    uint64_t seed = 0;                                      // Ensemble seed, replicates get their own streams under it
+    size_t numThreads = std::thread::hardware_concurrency(); // Number of worker threads
+};
+
+// Output of a single replicate
+struct ReplicateResult {
+    size_t replicate = 0;                                   // Index of the replicate
+    uint64_t seed = 0;                                      // Ensemble seed the replicate ran with
+    Observer observer;                                      // The replicate's event history
+    size_t finalPopulations = 0;                            // Number of populations alive at the end
+    double wallSeconds = 0.0;                               // Wall-clock time the replicate took
+};
+
+class EnsembleRunner {
+private:
+    EnsembleSettings settings;
+    size_t steals = 0;                                      // Steals during the last run
+
+public:
+    // Constructor
+    explicit EnsembleRunner(const EnsembleSettings& ensembleSettings) : settings(ensembleSettings) {}
+
+    // Run all replicates on a work-stealing pool, results are indexed by replicate
+    std::vector<ReplicateResult> run() {
+        std::vector<ReplicateResult> results(settings.numReplicates);
+
+        // Thousands of replicates reporting every step would serialize on stdout
+        bool wasVerbose = System::isVerbose();
+        System::setVerbose(false);
+
+        WorkStealingPool pool(settings.numThreads);
+        for (size_t replicate = 0; replicate < settings.numReplicates; ++replicate) {
+            pool.submit([this, replicate, &results]() {
+                auto start = std::chrono::steady_clock::now();
+                ReplicateResult& result = results[replicate];
+                result.replicate = replicate;
+                result.seed = settings.seed;
+
+                // Streams are keyed by (seed, replicate), so results do not depend on which worker runs what
+                Director director(settings.numIsolations, settings.birthRate, settings.deathRate, settings.method,
+                                  settings.seed, static_cast<uint32_t>(replicate));
+                director.simulate(settings.maxTime);
+
+                result.observer = director.getObserver();
+                for (const auto& isolation : director.getSystem().getAllIsolations()) {
+                    result.finalPopulations += isolation->getUnitPopulations().size();
+                }
+                result.wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            });
+        }
+
+        try {
+            pool.run();
+        } catch (...) {
+            System::setVerbose(wasVerbose);
+            throw;
+        }
+        System::setVerbose(wasVerbose);
+        steals = pool.getNumberOfSteals();
+
+        return results;
+    }
+
+    // Write the event history of every replicate to its own file in a directory
+    static void writeReplicateOutputs(const std::vector<ReplicateResult>& results, const std::string& directory) {
+        std::filesystem::create_directories(directory);
+        for (const auto& result : results) {
+            std::ofstream out(std::filesystem::path(directory) / ("replicate_" + std::to_string(result.replicate) + ".txt"));
+            out << "Replicate: " << result.replicate << " | Seed: " << result.seed
+                << " | Final populations: " << result.finalPopulations << "\n";
+            result.observer.writeEventHistory(out);
+        }
+    }
+
+    [[nodiscard]] size_t getNumberOfSteals() const {
+        return steals;
+    }
+};
+
+
+#endif //FUSION_ENSEMBLE_H
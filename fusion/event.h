@@ -9,10 +9,13 @@
 
 #include <iostream>
 #include <memory>
-#include <random>
+#include <stdexcept>
+#include <string>
 #include <vector>
 #include "unit_population.h"
 #include "isolation.h"
+#include "system.h"
+#include "random_service.h"
 
 // Event Base Class
 class Event {
@@ -24,119 +27,173 @@ public:
 // Population Event Base Class
 class PopulationEvent : public Event {
 protected:
-    std::shared_ptr<UnitPopulation> population;   // Target population for the event
+    PopulationId populationId;                    // Id of the target population for the event
+    PopulationHandle populationHandle;            // Handle of the target population in its island's store
     std::shared_ptr<Isolation> isolation;         // The isolation (island) on which the event takes place
     double mutationRate;                          // Independent mutation rate
 
+    // Resolve the handle of the target population to its current row, rows move so this is done per execution
+    [[nodiscard]] size_t getPopulationIndex() const {
+        size_t index = isolation->getUnitPopulations().indexOf(populationHandle);
+        if (index == PopulationStore::npos) {
+            throw std::runtime_error("Population " + std::to_string(populationId) + " not found on its island");
+        }
+        return index;
+    }
+
 public:
-    PopulationEvent(std::shared_ptr<UnitPopulation> pop, std::shared_ptr<Isolation> iso, double rate)
-            : population(pop), isolation(iso), mutationRate(rate) {}
+    PopulationEvent(PopulationId popId, PopulationHandle handle, std::shared_ptr<Isolation> iso, double rate)
+            : populationId(popId), populationHandle(handle), isolation(std::move(iso)), mutationRate(rate) {}
+
+    [[nodiscard]] PopulationId getPopulationId() const { return populationId; }
 
     virtual void execute() override = 0;
 };
 
+// Population Mutation Event
+class PopulationMutationEvent final : public PopulationEvent {
+private:
+    PopulationRef population;                     // Population to mutate, usually a newborn
+    RandomStream* random;                         // Stream deciding which property mutates
+    const char* mutatedProperty = "";             // Name of the property changed by the last execution
+    double oldValue = 0.0;                        // Property value before the mutation
+    double newValue = 0.0;                        // Property value after the mutation
+
+public:
+    PopulationMutationEvent(PopulationRef pop, RandomStream& rng, double rate)
+            : PopulationEvent(pop.getId(), {}, nullptr, rate), population(pop), random(&rng) {}
+
+    [[nodiscard]] int getLocationId() const { return population.getLocationId(); }
+    [[nodiscard]] const char* getMutatedProperty() const { return mutatedProperty; }
+    [[nodiscard]] double getOldValue() const { return oldValue; }
+    [[nodiscard]] double getNewValue() const { return newValue; }
+
+    void execute() override {
+        int mutation = static_cast<int>(random->uniformIndex(4));
+        switch (mutation) {
+            case 0:
+                mutatedProperty = "Mobility";
+                oldValue = population.getMobility();
+                population.setMobility(population.getMobility() + 0.1);  // Mobility mutation
+                newValue = population.getMobility();
+                break;
+            case 1:
+                mutatedProperty = "ResourceUse";
+                oldValue = population.getResourceUsePerNiche().empty() ? 0.0 : population.getResourceUsePerNiche()[0];
+                population.setResourceUse(0, 1.1);                         // Resource use mutation
+                newValue = 1.1;
+                break;
+            case 2:
+                mutatedProperty = "Reproductivity";
+                oldValue = population.getReproductivity();
+                population.setReproductivity(population.getReproductivity() + 0.1); // Reproductivity mutation
+                newValue = population.getReproductivity();
+                break;
+            case 3:
+                mutatedProperty = "MutationRate";
+                oldValue = population.getMutationRate();
+                population.setMutationRate(population.getMutationRate() + 0.01); // Intrinsic mutation rate mutation
+                newValue = population.getMutationRate();
+                break;
+        }
+        if (System::isVerbose()) {
+            std::cout << "Population mutation event executed.\n";
+        }
+    }
+};
+
 // Population Birth Event
-class PopulationBirthEvent : public PopulationEvent {
+class PopulationBirthEvent final : public PopulationEvent {
+private:
+    System* system;                               // System handing out unique population ids
+    RandomStream* random;                         // Stream deciding about mutations
+    PopulationId childId = -1;                    // Id of the child spawned by the last execution
+    PopulationHandle child;                       // Handle of the child spawned by the last execution
+
 public:
-    PopulationBirthEvent(std::shared_ptr<UnitPopulation> parent, std::shared_ptr<Isolation> iso, double rate)
-            : PopulationEvent(parent, iso, rate) {}
+    PopulationBirthEvent(PopulationId parentId, PopulationHandle parent, std::shared_ptr<Isolation> iso, System& sys,
+                         RandomStream& rng, double rate)
+            : PopulationEvent(parentId, parent, std::move(iso), rate), system(&sys), random(&rng) {}
+
+    [[nodiscard]] PopulationId getParentId() const { return populationId; }
+    [[nodiscard]] PopulationId getChildId() const { return childId; }
+    [[nodiscard]] PopulationHandle getChildHandle() const { return child; }
+    [[nodiscard]] int getLocationId() const { return isolation->getId(); }
 
     void execute() override {
-        // Spawn a child population
-        auto child = std::make_shared<UnitPopulation>(population->getId() + 1, population->getLocationId(),
-                                                      population->getId(), population->getMutationRate(),
-                                                      population->getMobility(), population->getResourceUsePerNiche(),
-                                                      population->getReproductivity());
+        // Spawn a child population on the island as a copy of its parent
+        PopulationStore& populations = isolation->getPopulationStore();
+        childId = system->allocatePopulationId();
+        size_t childIndex = populations.addClone(populations, getPopulationIndex(), childId, isolation->getId());
+        child = populations.getHandle(childIndex);
 
         // Perform mutation with a certain probability
-        std::random_device rd;
-        std::mt19937 gen(rd());
-        std::uniform_real_distribution<> dis(0.0, 1.0);
-
-        if (dis(gen) < mutationRate) {
-            auto mutation = std::make_shared<PopulationMutationEvent>(child, mutationRate);
-            mutation->execute();
+        if (random->uniform() < mutationRate) {
+            PopulationMutationEvent mutation(populations.at(childIndex), *random, mutationRate);
+            mutation.execute();
+        }
+        if (System::isVerbose()) {
+            std::cout << "Population birth event executed.\n";
         }
-
-        // Add the child to the island
-        isolation->addUnitPopulation(child);
-        std::cout << "Population birth event executed.\n";
     }
 };
 
 // Population Death Event
-class PopulationDeathEvent : public PopulationEvent {
+class PopulationDeathEvent final : public PopulationEvent {
 public:
-    PopulationDeathEvent(std::shared_ptr<UnitPopulation> pop, std::shared_ptr<Isolation> iso)
-            : PopulationEvent(pop, iso, 0.0) {}
+    PopulationDeathEvent(PopulationId popId, PopulationHandle handle, std::shared_ptr<Isolation> iso)
+            : PopulationEvent(popId, handle, std::move(iso), 0.0) {}
 
     void execute() override {
         // Remove the population from the island
-        isolation->removeUnitPopulation(population->getId());
-        std::cout << "Population death event executed.\n";
+        if (!isolation->removeUnitPopulation(populationHandle)) {
+            throw std::runtime_error("Population " + std::to_string(populationId) + " not found on its island");
+        }
+        if (System::isVerbose()) {
+            std::cout << "Population death event executed.\n";
+        }
     }
 };
 
-// Population Immigration Event
-class PopulationImmigrationEvent : public PopulationEvent {
+// Population Immigration Event, a lumped emigration from the source island whose destination is drawn on execution
+class PopulationImmigrationEvent final : public PopulationEvent {
 private:
-    std::shared_ptr<Isolation> targetIsolation;  // Target isolation (different island)
+    System* system;                              // System owning the emigration tables and handing out population ids
+    RandomStream* random;                        // Stream deciding about destinations and mutations
+    int targetIsolationId = -1;                  // Destination of the last execution
+    PopulationId childId = -1;                   // Id of the child spawned by the last execution
+    PopulationHandle child;                      // Handle of the child spawned by the last execution
 
 public:
-    PopulationImmigrationEvent(std::shared_ptr<UnitPopulation> parent, std::shared_ptr<Isolation> srcIso,
-                               std::shared_ptr<Isolation> tgtIso, double rate)
-            : PopulationEvent(parent, srcIso, rate), targetIsolation(tgtIso) {}
+    PopulationImmigrationEvent(PopulationId parentId, PopulationHandle parent, std::shared_ptr<Isolation> srcIso, System& sys,
+                               RandomStream& rng, double rate)
+            : PopulationEvent(parentId, parent, std::move(srcIso), rate), system(&sys), random(&rng) {}
+
+    [[nodiscard]] PopulationId getChildId() const { return childId; }
+    [[nodiscard]] PopulationHandle getChildHandle() const { return child; }
+    [[nodiscard]] int getFromLocation() const { return isolation->getId(); }
+    [[nodiscard]] int getToLocation() const { return targetIsolationId; }
 
     void execute() override {
-        // Spawn a child population on the target island
-        auto child = std::make_shared<UnitPopulation>(population->getId() + 1, targetIsolation->getId(),
-                                                      population->getId(), population->getMutationRate(),
-                                                      population->getMobility(), population->getResourceUsePerNiche(),
-                                                      population->getReproductivity());
+        // Draw the destination with probability proportional to 1 - barrier
+        targetIsolationId = system->sampleEmigrationTarget(isolation->getId(), *random);
+        auto targetIsolation = system->getIsolation(targetIsolationId);
 
-        // Perform mutation with a certain probability
-        std::random_device rd;
-        std::mt19937 gen(rd());
-        std::uniform_real_distribution<> dis(0.0, 1.0);
+        // Spawn a child population on the target island as a copy of its parent
+        PopulationStore& targetPopulations = targetIsolation->getPopulationStore();
+        childId = system->allocatePopulationId();
+        size_t childIndex = targetPopulations.addClone(isolation->getUnitPopulations(), getPopulationIndex(), childId,
+                                                       targetIsolationId);
+        child = targetPopulations.getHandle(childIndex);
 
-        if (dis(gen) < mutationRate) {
-            auto mutation = std::make_shared<PopulationMutationEvent>(child, mutationRate);
-            mutation->execute();
+        // Perform mutation with a certain probability
+        if (random->uniform() < mutationRate) {
+            PopulationMutationEvent mutation(targetPopulations.at(childIndex), *random, mutationRate);
+            mutation.execute();
         }
-
-        // Add the child to the target island
-        targetIsolation->addUnitPopulation(child);
-        std::cout << "Population immigration event executed.\n";
-    }
-};
-
-// Population Mutation Event
-class PopulationMutationEvent : public PopulationEvent {
-public:
-    PopulationMutationEvent(std::shared_ptr<UnitPopulation> pop, double rate)
-            : PopulationEvent(pop, nullptr, rate) {}
-
-    void execute() override {
-        std::random_device rd;
-        std::mt19937 gen(rd());
-        std::uniform_int_distribution<> mutationType(0, 3);
-
-        int mutation = mutationType(gen);
-        switch (mutation) {
-            case 0:
-                population->setMobility(population->getMobility() + 0.1);  // Mobility mutation
-                break;
-            case 1:
-                population->setResourceUsePerNiche({1.1});                 // Resource use mutation
-                break;
-            case 2:
-                population->setReproductivity(population->getReproductivity() + 0.1); // Reproductivity mutation
-                break;
-            case 3:
-                population->setMutationRate(population->getMutationRate() + 0.01); // Intrinsic mutation rate mutation
-                break;
+        if (System::isVerbose()) {
+            std::cout << "Population immigration event executed.\n";
         }
-        std::cout << "Population mutation event executed.\n";
     }
 };
 
@@ -146,39 +203,51 @@ protected:
     std::shared_ptr<Isolation> isolation; // Target isolation for the event
 
 public:
-    IsolationEvent(std::shared_ptr<Isolation> iso) : isolation(iso) {}
+    IsolationEvent(std::shared_ptr<Isolation> iso) : isolation(std::move(iso)) {}
+
+    [[nodiscard]] int getIsolationId() const { return isolation->getId(); }
 
     virtual void execute() override = 0;
 };
 
 // Resource Availability Change Event
-class ResourceAvailabilityChangeEvent : public IsolationEvent {
+class ResourceAvailabilityChangeEvent final : public IsolationEvent {
 private:
-    std::vector<double> newResourceAvailability;
+    const std::vector<double>* newResourceAvailability; // Owned by the caller, must outlive the event
 
 public:
     ResourceAvailabilityChangeEvent(std::shared_ptr<Isolation> iso, const std::vector<double>& resources)
-            : IsolationEvent(iso), newResourceAvailability(resources) {}
+            : IsolationEvent(std::move(iso)), newResourceAvailability(&resources) {}
 
     void execute() override {
-        isolation->setResourceAvailability(newResourceAvailability);
-        std::cout << "Resource availability change event executed.\n";
+        isolation->setResourceAvailability(*newResourceAvailability);
+        if (System::isVerbose()) {
+            std::cout << "Resource availability change event executed.\n";
+        }
     }
 };
 
-// Barrier Threshold Change Event
-class BarrierThresholdChangeEvent : public IsolationEvent {
+// Barrier Threshold Change Event, sets the barrier between the isolation and its neighbours (every other isolation
+// unless the system is large enough to keep its barriers sparse)
+class BarrierThresholdChangeEvent final : public IsolationEvent {
 private:
+    System* system;                              // System owning the barrier threshold matrix
     double newThreshold;
+    const std::vector<int>* changedIsolations = nullptr;   // Owned by the system, valid until its next barrier change
 
 public:
-    BarrierThresholdChangeEvent(std::shared_ptr<Isolation> iso, double threshold)
-            : IsolationEvent(iso), newThreshold(threshold) {}
+    BarrierThresholdChangeEvent(std::shared_ptr<Isolation> iso, System& sys, double threshold)
+            : IsolationEvent(std::move(iso)), system(&sys), newThreshold(threshold) {}
 
     void execute() override {
-        isolation->setBarrierThreshold(newThreshold);
-        std::cout << "Barrier threshold change event executed.\n";
+        changedIsolations = &system->setIsolationBarriers(isolation->getId(), newThreshold);
+        if (System::isVerbose()) {
+            std::cout << "Barrier threshold change event executed.\n";
+        }
     }
+
+    // Get the isolations whose barrier rows the event changed, the isolation itself first
+    [[nodiscard]] const std::vector<int>& getChangedIsolations() const { return *changedIsolations; }
 };
 
 
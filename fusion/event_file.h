@@ -0,0 +1,246 @@
+//
+// Created by Tianjian Qin on 10/16/2026.
+// Layout of event history files and the class writing them, fixed-width binary records in blocks with sparse indices
+//
+
+#ifndef FUSION_EVENT_FILE_H
+#define FUSION_EVENT_FILE_H
+
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "event_log.h"
+
+// An event history file is
+// - a 64-byte header, rewritten when the file is closed,
+// - blocks of blockRecords records of 64 bytes each in the order they were logged (the last one may be shorter), every
+//   block followed by a Bloom filter of filterBytes over the population and parent ids of its records,
+// - the block index, one entry per block with the time and id ranges of its records,
+// - the names of the mutated properties the records refer to, each a 32-bit length followed by the characters.
+// Numbers are stored in the byte order of the machine that wrote the file.
+struct EventFileHeader {
+    char magic[8];                  // "FUSIONEV"
+    uint32_t version;               // Layout version
+    uint32_t recordBytes;           // Size of one record
+    uint64_t numRecords;            // Number of records
+    uint64_t dictionaryOffset;      // Offset of the property names, 0 while the file is being written
+    uint32_t numProperties;         // Number of property names
+    uint32_t blockRecords;          // Records per block
+    uint64_t indexOffset;           // Offset of the block index
+    uint32_t filterBytes;           // Size of the filter behind every block
+    uint32_t reserved0;
+    uint64_t reserved1;
+};
+
+// Index entry of a block, the ranges of times and of population and parent ids in it
+struct EventBlockEntry {
+    double minTime;
+    double maxTime;
+    int64_t minPopulation;
+    int64_t maxPopulation;
+};
+
+inline constexpr char eventFileMagic[8] = {'F', 'U', 'S', 'I', 'O', 'N', 'E', 'V'};
+inline constexpr uint32_t eventFileVersion = 2;
+inline constexpr size_t eventRecordBytes = 64;
+inline constexpr size_t eventFilterProbes = 4;
+
+static_assert(sizeof(EventFileHeader) == 64, "Event file headers are 64 bytes");
+static_assert(sizeof(EventBlockEntry) == 32, "Event block entries are 32 bytes");
+
+// Write a record as time, population, parent, source, target, old value, new value, property (32 bits) and type
+// (8 bits), padded with zeros
+inline void encodeEventRecord(const EventRecord& record, unsigned char* out) {
+    auto property = static_cast<int32_t>(record.property);
+    std::memcpy(out, &record.time, 8);
+    std::memcpy(out + 8, &record.population, 8);
+    std::memcpy(out + 16, &record.parent, 8);
+    std::memcpy(out + 24, &record.source, 8);
+    std::memcpy(out + 32, &record.target, 8);
+    std::memcpy(out + 40, &record.oldValue, 8);
+    std::memcpy(out + 48, &record.newValue, 8);
+    std::memcpy(out + 56, &property, 4);
+    out[60] = static_cast<unsigned char>(record.type);
+    out[61] = out[62] = out[63] = 0;
+}
+
+// Read a record written by encodeEventRecord
+inline EventRecord decodeEventRecord(const unsigned char* in) {
+    EventRecord record{};
+    int32_t property;
+    std::memcpy(&record.time, in, 8);
+    std::memcpy(&record.population, in + 8, 8);
+    std::memcpy(&record.parent, in + 16, 8);
+    std::memcpy(&record.source, in + 24, 8);
+    std::memcpy(&record.target, in + 32, 8);
+    std::memcpy(&record.oldValue, in + 40, 8);
+    std::memcpy(&record.newValue, in + 48, 8);
+    std::memcpy(&property, in + 56, 4);
+    record.property = property;
+    record.type = static_cast<EventType>(in[60]);
+    return record;
+}
+
+// Bit positions of an id in a block filter of a power-of-two number of bits, double hashing of a 64-bit mix
+template <typename F>
+inline void forEachFilterBit(PopulationId id, size_t filterBits, F&& f) {
+    uint64_t hash = static_cast<uint64_t>(id) + 0x9e3779b97f4a7c15ULL;
+    hash = (hash ^ (hash >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    hash = (hash ^ (hash >> 27)) * 0x94d049bb133111ebULL;
+    hash ^= hash >> 31;
+    uint64_t step = (hash >> 32) | 1;
+    for (size_t probe = 0; probe < eventFilterProbes; ++probe) {
+        f(static_cast<size_t>(hash + probe * step) & (filterBits - 1));
+    }
+}
+
+// Writes records to an event history file block by block, each block with its filter in a single write. Only the
+// block being filled and the small block index are held in memory.
+class EventFileWriter {
+public:
+    static constexpr size_t defaultBlockRecords = 4096;     // 256 KiB of records per block
+
+private:
+    std::ofstream file;
+    size_t blockRecords;
+    size_t filterBytes;                          // Eight bits per id a block can hold, rounded up to a power of two
+    std::vector<unsigned char> block;            // Records of the current block followed by its filter
+    size_t blockFill = 0;                        // Records in the current block
+    EventBlockEntry entry{};                     // Index entry of the current block
+    std::vector<EventBlockEntry> index;          // Entries of the written blocks
+    uint64_t numRecords = 0;
+    uint64_t writes = 0;
+    bool open = true;
+
+    void writeHeader(uint64_t dictionaryOffset, uint64_t indexOffset, size_t numProperties) {
+        EventFileHeader header{};
+        std::memcpy(header.magic, eventFileMagic, sizeof(header.magic));
+        header.version = eventFileVersion;
+        header.recordBytes = eventRecordBytes;
+        header.numRecords = numRecords;
+        header.dictionaryOffset = dictionaryOffset;
+        header.numProperties = static_cast<uint32_t>(numProperties);
+        header.blockRecords = static_cast<uint32_t>(blockRecords);
+        header.indexOffset = indexOffset;
+        header.filterBytes = static_cast<uint32_t>(filterBytes);
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    }
+
+    void resetBlock() {
+        blockFill = 0;
+        entry = {std::numeric_limits<double>::infinity(), -std::numeric_limits<double>::infinity(),
+                 std::numeric_limits<int64_t>::max(), std::numeric_limits<int64_t>::min()};
+        std::fill(block.begin() + static_cast<std::ptrdiff_t>(blockRecords * eventRecordBytes), block.end(), 0);
+    }
+
+    void addToFilter(PopulationId id) {
+        if (id < 0) {
+            return;
+        }
+        entry.minPopulation = std::min(entry.minPopulation, id);
+        entry.maxPopulation = std::max(entry.maxPopulation, id);
+        unsigned char* filter = block.data() + blockRecords * eventRecordBytes;
+        forEachFilterBit(id, filterBytes * 8, [filter](size_t bit) { filter[bit / 8] |= 1u << (bit % 8); });
+    }
+
+    // Write the records of the current block and its filter
+    void writeBlock() {
+        if (blockFill == 0) {
+            return;
+        }
+        size_t recordBytes = blockFill * eventRecordBytes;
+        if (blockFill < blockRecords) {
+            std::copy_n(block.begin() + static_cast<std::ptrdiff_t>(blockRecords * eventRecordBytes), filterBytes,
+                        block.begin() + static_cast<std::ptrdiff_t>(recordBytes));
+        }
+        file.write(reinterpret_cast<const char*>(block.data()), static_cast<std::streamsize>(recordBytes + filterBytes));
+        if (!file) {
+            throw std::runtime_error("Writing the event file failed");
+        }
+        ++writes;
+        index.push_back(entry);
+        resetBlock();
+    }
+
+public:
+    // Create the file, throws if it cannot be opened
+    explicit EventFileWriter(const std::string& path, size_t recordsPerBlock = defaultBlockRecords)
+            : file(path, std::ios::binary | std::ios::trunc), blockRecords(std::max<size_t>(recordsPerBlock, 1)),
+              filterBytes(std::bit_ceil(std::max<size_t>(blockRecords * 2, 64))),
+              block(blockRecords * eventRecordBytes + filterBytes) {
+        if (!file) {
+            throw std::runtime_error("Cannot open event file " + path);
+        }
+        writeHeader(0, 0, 0);
+        resetBlock();
+    }
+
+    EventFileWriter(const EventFileWriter&) = delete;
+    EventFileWriter& operator=(const EventFileWriter&) = delete;
+
+    // Append a record, throws if writing the block it completes fails
+    void append(const EventRecord& record) {
+        encodeEventRecord(record, block.data() + blockFill * eventRecordBytes);
+        entry.minTime = std::min(entry.minTime, record.time);
+        entry.maxTime = std::max(entry.maxTime, record.time);
+        addToFilter(record.population);
+        addToFilter(record.parent);
+        ++numRecords;
+        if (++blockFill == blockRecords) {
+            writeBlock();
+        }
+    }
+
+    // Write the last block, the index and the property names the records refer to by index, then complete the header.
+    // Throws if anything could not be written.
+    void close(const std::vector<std::string>& propertyNames) {
+        if (!open) {
+            return;
+        }
+        open = false;
+        writeBlock();
+        auto indexOffset = static_cast<uint64_t>(file.tellp());
+        file.write(reinterpret_cast<const char*>(index.data()),
+                   static_cast<std::streamsize>(index.size() * sizeof(EventBlockEntry)));
+        auto dictionaryOffset = static_cast<uint64_t>(file.tellp());
+        for (const std::string& name : propertyNames) {
+            auto length = static_cast<uint32_t>(name.size());
+            file.write(reinterpret_cast<const char*>(&length), sizeof(length));
+            file.write(name.data(), static_cast<std::streamsize>(name.size()));
+        }
+        file.seekp(0);
+        writeHeader(dictionaryOffset, indexOffset, propertyNames.size());
+        file.close();
+        if (file.fail()) {
+            throw std::runtime_error("Writing the event file failed");
+        }
+    }
+
+    // Whether every write so far succeeded
+    [[nodiscard]] bool good() const {
+        return file.good();
+    }
+
+    [[nodiscard]] uint64_t getNumberOfRecords() const {
+        return numRecords;
+    }
+
+    [[nodiscard]] uint64_t getNumberOfWrites() const {
+        return writes;
+    }
+
+    // Get the memory the writer holds, the current block and the index
+    [[nodiscard]] size_t getBufferBytes() const {
+        return block.size() + index.capacity() * sizeof(EventBlockEntry);
+    }
+};
+
+
+#endif //FUSION_EVENT_FILE_H
@@ -0,0 +1,274 @@
+//
+// Created by Tianjian Qin on 10/16/2026.
+// Class definition for the event file reader, which maps an event history file into memory and answers time range and
+// population queries from its block index
+//
+
+#ifndef FUSION_EVENT_FILE_READER_H
+#define FUSION_EVENT_FILE_READER_H
+
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "event_file.h"
+#include "mapped_file.h"
+
+// Maps the file read-only and leaves paging to the operating system, so only the header, the block index and the
+// blocks a query touches are ever read from disk. Queries first rule out blocks by the time or id ranges in the index,
+// population queries then by the Bloom filter of each remaining block, and only scan the records of the blocks left.
+// Queries only read the mapping and may run from several threads at once.
+class EventFileReader {
+private:
+    MappedFile file;
+    const unsigned char* data;                   // Contents of the file
+    size_t length;                               // Size of the file
+    EventFileHeader header{};
+    std::vector<EventBlockEntry> index;          // Block index
+    std::vector<int64_t> maxPopulationUpTo;      // Per block the largest id in it or any block before it
+    size_t numBlocks = 0;
+    bool timeOrdered = true;                     // Whether block time ranges never go back, so they can be searched
+    size_t blockStride = 0;                      // Bytes from one block to the next, records and filter
+    std::vector<std::string> propertyNames;
+
+    [[nodiscard]] const EventBlockEntry& entry(size_t block) const {
+        return index[block];
+    }
+
+    [[nodiscard]] const unsigned char* blockRecords(size_t block) const {
+        return data + sizeof(EventFileHeader) + block * blockStride;
+    }
+
+    [[nodiscard]] size_t recordsInBlock(size_t block) const {
+        return block + 1 < numBlocks ? header.blockRecords : header.numRecords - block * header.blockRecords;
+    }
+
+    // Whether a block may hold records of a population, by its id range and filter
+    [[nodiscard]] bool mayContain(size_t block, PopulationId id) const {
+        const EventBlockEntry& blockEntry = entry(block);
+        if (id < blockEntry.minPopulation || id > blockEntry.maxPopulation) {
+            return false;
+        }
+        const unsigned char* filter = blockRecords(block) + recordsInBlock(block) * eventRecordBytes;
+        bool present = true;
+        forEachFilterBit(id, static_cast<size_t>(header.filterBytes) * 8, [&](size_t bit) {
+            present = present && (filter[bit / 8] >> (bit % 8) & 1u);
+        });
+        return present;
+    }
+
+    // Find the record creating a population in one block
+    bool findCreationInBlock(size_t block, PopulationId id, EventRecord& creation) const {
+        if (!mayContain(block, id)) {
+            return false;
+        }
+        const unsigned char* records = blockRecords(block);
+        for (size_t i = 0; i < recordsInBlock(block); ++i) {
+            EventRecord record = decodeEventRecord(records + i * eventRecordBytes);
+            bool creates = record.type == EventType::Birth || record.type == EventType::Immigration;
+            if (creates && record.population == id) {
+                creation = record;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    [[noreturn]] static void fail(const std::string& path, const char* reason) {
+        throw std::runtime_error("Cannot read event file " + path + ": " + reason);
+    }
+
+public:
+    // Map a completed event file, throws if it cannot be read or is not a complete event file
+    explicit EventFileReader(const std::string& path) : file(path), data(file.getData()), length(file.size()) {
+        if (length < sizeof(EventFileHeader)) {
+            fail(path, "too short");
+        }
+        std::memcpy(&header, data, sizeof(header));
+        if (std::memcmp(header.magic, eventFileMagic, sizeof(header.magic)) != 0) {
+            fail(path, "not an event file");
+        }
+        if (header.version != eventFileVersion || header.recordBytes != eventRecordBytes || header.blockRecords == 0 ||
+            !std::has_single_bit(header.filterBytes)) {
+            fail(path, "unsupported layout");
+        }
+        if (header.dictionaryOffset == 0) {
+            fail(path, "the file was not completed");
+        }
+        if (header.numRecords > length / eventRecordBytes || header.indexOffset > length) {
+            fail(path, "truncated");
+        }
+        numBlocks = (header.numRecords + header.blockRecords - 1) / header.blockRecords;
+        if (numBlocks > 0 && header.filterBytes > length) {
+            fail(path, "truncated");
+        }
+        blockStride = static_cast<size_t>(header.blockRecords) * eventRecordBytes + header.filterBytes;
+        size_t recordsEnd = sizeof(EventFileHeader) + header.numRecords * eventRecordBytes +
+                            numBlocks * header.filterBytes;
+        if (header.indexOffset < recordsEnd || header.indexOffset + numBlocks * sizeof(EventBlockEntry) > length ||
+            header.dictionaryOffset > length) {
+            fail(path, "truncated");
+        }
+        index.resize(numBlocks);
+        if (numBlocks > 0) {
+            std::memcpy(index.data(), data + header.indexOffset, numBlocks * sizeof(EventBlockEntry));
+        }
+        for (size_t block = 1; block < numBlocks; ++block) {
+            timeOrdered = timeOrdered && index[block].minTime >= index[block - 1].minTime &&
+                          index[block].maxTime >= index[block - 1].maxTime;
+        }
+        maxPopulationUpTo.resize(numBlocks);
+        for (size_t block = 0; block < numBlocks; ++block) {
+            maxPopulationUpTo[block] = std::max(index[block].maxPopulation,
+                                                block > 0 ? maxPopulationUpTo[block - 1] : index[block].maxPopulation);
+        }
+
+        size_t offset = header.dictionaryOffset;
+        for (uint32_t property = 0; property < header.numProperties; ++property) {
+            uint32_t nameLength;
+            if (offset + sizeof(nameLength) > length) {
+                fail(path, "truncated");
+            }
+            std::memcpy(&nameLength, data + offset, sizeof(nameLength));
+            offset += sizeof(nameLength);
+            if (offset + nameLength > length) {
+                fail(path, "truncated");
+            }
+            propertyNames.emplace_back(reinterpret_cast<const char*>(data + offset), nameLength);
+            offset += nameLength;
+        }
+    }
+
+    EventFileReader(const EventFileReader&) = delete;
+    EventFileReader& operator=(const EventFileReader&) = delete;
+
+    // Get a record by its position in the file
+    [[nodiscard]] EventRecord getRecord(size_t position) const {
+        if (position >= header.numRecords) {
+            throw std::out_of_range("Event record index is out of bounds");
+        }
+        size_t block = position / header.blockRecords;
+        return decodeEventRecord(blockRecords(block) + (position % header.blockRecords) * eventRecordBytes);
+    }
+
+    // Call f(record) for every record with a time in [from, to], in file order, returns the number of blocks read. Files
+    // logged in time order are searched for the first block ending at or after from and read up to the first block
+    // starting after to, others are scanned block by block.
+    template <typename F>
+    size_t forEachInTimeRange(double from, double to, F&& f) const {
+        size_t blocksRead = 0;
+        size_t first = 0;
+        if (timeOrdered) {
+            first = static_cast<size_t>(std::lower_bound(index.begin(), index.end(), from,
+                                                         [](const EventBlockEntry& blockEntry, double time) {
+                                                             return blockEntry.maxTime < time;
+                                                         }) - index.begin());
+        }
+        for (size_t block = first; block < numBlocks; ++block) {
+            const EventBlockEntry& blockEntry = entry(block);
+            if (timeOrdered && blockEntry.minTime > to) {
+                break;
+            }
+            if (blockEntry.maxTime < from || blockEntry.minTime > to) {
+                continue;
+            }
+            ++blocksRead;
+            const unsigned char* records = blockRecords(block);
+            for (size_t i = 0; i < recordsInBlock(block); ++i) {
+                EventRecord record = decodeEventRecord(records + i * eventRecordBytes);
+                if (record.time >= from && record.time <= to) {
+                    f(record);
+                }
+            }
+        }
+        return blocksRead;
+    }
+
+    // Call f(record) for every record of a population: the events it underwent, the one creating it and the births and
+    // emigrations it was the parent of, in file order. Returns the number of blocks read.
+    template <typename F>
+    size_t forEachOfPopulation(PopulationId id, F&& f) const {
+        size_t blocksRead = 0;
+        for (size_t block = 0; block < numBlocks; ++block) {
+            if (!mayContain(block, id)) {
+                continue;
+            }
+            ++blocksRead;
+            const unsigned char* records = blockRecords(block);
+            for (size_t i = 0; i < recordsInBlock(block); ++i) {
+                EventRecord record = decodeEventRecord(records + i * eventRecordBytes);
+                if (record.population == id || record.parent == id) {
+                    f(record);
+                }
+            }
+        }
+        return blocksRead;
+    }
+
+    // Get every record with a time in [from, to]
+    [[nodiscard]] std::vector<EventRecord> getEventsBetween(double from, double to) const {
+        std::vector<EventRecord> events;
+        forEachInTimeRange(from, to, [&events](const EventRecord& record) { events.push_back(record); });
+        return events;
+    }
+
+    // Get every record of a population
+    [[nodiscard]] std::vector<EventRecord> getEventsOfPopulation(PopulationId id) const {
+        std::vector<EventRecord> events;
+        forEachOfPopulation(id, [&events](const EventRecord& record) { events.push_back(record); });
+        return events;
+    }
+
+    // Get the birth or immigration that created a population, false for the populations the run started with. The
+    // search starts at the first block holding an id as large, found by binary search, and as a population is created
+    // before any record names it, it usually ends in the first block whose filter lets the id pass.
+    bool findCreation(PopulationId id, EventRecord& creation) const {
+        auto first = static_cast<size_t>(std::lower_bound(maxPopulationUpTo.begin(), maxPopulationUpTo.end(), id) -
+                                         maxPopulationUpTo.begin());
+        for (size_t block = first; block < numBlocks; ++block) {
+            if (findCreationInBlock(block, id, creation)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Get the lineage of a population, the records creating it, its parent, its parent's parent and so on back to a
+    // population the run started with. Each generation costs a binary search of the block index and the blocks read up
+    // to its creation, but the search for the creation of that first population fails only after reading every later
+    // block its filter lets pass. A lineage cannot be longer than the file, which ends the walk should a damaged file
+    // loop back on itself.
+    [[nodiscard]] std::vector<EventRecord> getLineage(PopulationId id) const {
+        std::vector<EventRecord> lineage;
+        EventRecord creation{};
+        while (id >= 0 && lineage.size() < header.numRecords && findCreation(id, creation)) {
+            lineage.push_back(creation);
+            id = creation.parent;
+        }
+        return lineage;
+    }
+
+    // Get the name of a mutated property from the index in a record
+    [[nodiscard]] const std::string& getPropertyName(int64_t property) const {
+        return propertyNames.at(static_cast<size_t>(property));
+    }
+
+    [[nodiscard]] size_t size() const {
+        return header.numRecords;
+    }
+
+    [[nodiscard]] size_t getNumberOfBlocks() const {
+        return numBlocks;
+    }
+
+    [[nodiscard]] size_t getFileBytes() const {
+        return length;
+    }
+};
+
+
+#endif //FUSION_EVENT_FILE_READER_H
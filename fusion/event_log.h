@@ -0,0 +1,342 @@
+//
+// Created by Tianjian Qin on 10/16/2026.
+// Class definition for the event log, the logged events of a run stored as variable-length bytes
+//
+
+#ifndef FUSION_EVENT_LOG_H
+#define FUSION_EVENT_LOG_H
+
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <queue>
+#include <utility>
+#include <vector>
+#include "byte_codec.h"
+#include "population_id.h"
+
+// Type of a logged event
+enum class EventType : uint8_t {
+    Birth,
+    Death,
+    Immigration,
+    Mutation
+};
+
+// A logged event as one fixed-width record, fields an event type does not use are -1 (or 0 for the values)
+struct EventRecord {
+    EventType type;                 // Event type (birth, death, immigration, mutation)
+    double time;                    // Time at which the event occurred
+    PopulationId population;        // Acting population, the new one for births and immigrations
+    PopulationId parent;            // Population a birth or an immigration descends from
+    int64_t source;                 // Island of the event, the source island of immigrations (-1 for deaths)
+    int64_t target;                 // Destination island of an immigration
+    int64_t property;               // Property changed by a mutation, an index into the property names of the log
+    double oldValue;                // Property value before a mutation
+    double newValue;                // Property value after a mutation
+};
+
+// Events kept as variable-length bytes rather than as records. Every event stores its time as a zigzag varint of the
+// difference of its bit pattern to the time before, so times stay exact, then its population as a zigzag varint of the
+// difference to the population before, with the type in the two low bits (ids stay far below 2^61). Births and
+// immigrations add the parent as a difference to the population and the island(s), mutations the island, the property,
+// the old value raw and the new one XOR the old. The differences start over every blockEvents events, so a rollback
+// only re-reads the block it cuts into. The bytes go into chunks that are allocated at their full size and never grow,
+// doubling from minChunkBytes up to maxChunkBytes, so there is no growth slack beyond the chunk being filled.
+//
+// A 3-island run takes about 11.5 bytes per event, block index and unfilled chunk included, against about 100 bytes
+// and two allocations for the original string records and 41 to 47 for plain typed columns with their growth slack.
+// That is close to a tenfold cut but not quite, and short logs pay more for their first chunk. Nothing is formatted,
+// and appending allocates only a new chunk every few thousand events. Property names are kept once in a small
+// dictionary. Events are read back in order through a cursor that decodes one event at a time.
+class EventLog {
+public:
+    static constexpr size_t blockEvents = 32;           // Events in one block
+    static constexpr size_t minChunkBytes = 256;        // Size of the first chunk
+    static constexpr size_t maxChunkBytes = 65536;      // Size chunks stop doubling at
+    static constexpr size_t maxEventBytes = 64;         // Bound on the encoding of one event
+
+    // Position of a reader: the next event, where its bytes are and what its differences are taken against
+    struct Cursor {
+        size_t event = 0;
+        size_t chunk = 0;
+        size_t offset = 0;
+        uint64_t previousTime = 0;
+        PopulationId previousPopulation = 0;
+    };
+
+private:
+    // Where a block starts
+    struct LogBlock {
+        uint32_t chunk;
+        uint32_t offset;
+        double firstTime;                   // Time of its first event
+    };
+
+    std::vector<std::vector<unsigned char>> chunks;  // Encoded events, chunks after currentChunk are empty spares
+    size_t currentChunk = 0;                         // Chunk being filled
+    std::vector<LogBlock> blocks;                    // Block b holds events b * blockEvents on
+    size_t numEvents = 0;
+    uint64_t previousTime = 0;                       // Bit pattern of the time of the last event
+    PopulationId previousPopulation = 0;             // Population of the last event
+    std::vector<const char*> propertyNames;          // Dictionary of mutated property names
+
+    // Index of a property name in the dictionary, added if new
+    uint8_t internProperty(const char* name) {
+        for (size_t i = 0; i < propertyNames.size(); ++i) {
+            if (propertyNames[i] == name || std::strcmp(propertyNames[i], name) == 0) {
+                return static_cast<uint8_t>(i);
+            }
+        }
+        propertyNames.push_back(name);
+        return static_cast<uint8_t>(propertyNames.size() - 1);
+    }
+
+    [[nodiscard]] size_t chunkRoom(size_t chunk) const {
+        return chunks[chunk].capacity() - chunks[chunk].size();
+    }
+
+    // Write the fields every event has, moving on to a new chunk or block first where needed, returns the bytes to
+    // append the remaining fields to. A block may go on in the next chunk.
+    std::vector<unsigned char>& appendCommon(EventType type, double time, PopulationId population) {
+        if (chunks.empty() || chunkRoom(currentChunk) < maxEventBytes) {
+            currentChunk += chunks.empty() ? 0 : 1;
+            if (currentChunk == chunks.size()) {
+                size_t bytes = chunks.empty() ? minChunkBytes : std::min(2 * chunks.back().capacity(), maxChunkBytes);
+                chunks.emplace_back().reserve(bytes);
+            }
+        }
+        std::vector<unsigned char>& out = chunks[currentChunk];
+        if (numEvents % blockEvents == 0) {
+            blocks.push_back({static_cast<uint32_t>(currentChunk), static_cast<uint32_t>(out.size()), time});
+            previousTime = 0;
+            previousPopulation = 0;
+        }
+
+        auto timeBits = std::bit_cast<uint64_t>(time);
+        putVarint(zigzagEncode(static_cast<int64_t>(timeBits - previousTime)), out);
+        putVarint(zigzagEncode(population - previousPopulation) << 2 | static_cast<uint8_t>(type), out);
+        previousTime = timeBits;
+        previousPopulation = population;
+        ++numEvents;
+        return out;
+    }
+
+    // Append a record read from another log, translating its property index
+    void appendFrom(const EventLog& other, const EventRecord& record) {
+        switch (record.type) {
+            case EventType::Birth:
+                appendBirth(record.time, record.parent, record.population, static_cast<int>(record.source));
+                break;
+            case EventType::Death:
+                appendDeath(record.time, record.population);
+                break;
+            case EventType::Immigration:
+                appendImmigration(record.time, record.parent, record.population, static_cast<int>(record.source),
+                                  static_cast<int>(record.target));
+                break;
+            case EventType::Mutation:
+                appendMutation(record.time, record.population, static_cast<int>(record.source),
+                               other.getPropertyName(record.property), record.oldValue, record.newValue);
+                break;
+        }
+    }
+
+public:
+    void appendBirth(double time, PopulationId parentId, PopulationId childId, int locationId) {
+        std::vector<unsigned char>& out = appendCommon(EventType::Birth, time, childId);
+        putVarint(zigzagEncode(parentId - childId), out);
+        putVarint(zigzagEncode(locationId), out);
+    }
+
+    void appendDeath(double time, PopulationId populationId) {
+        appendCommon(EventType::Death, time, populationId);
+    }
+
+    void appendImmigration(double time, PopulationId populationId, PopulationId childId, int fromLocationId,
+                           int toLocationId) {
+        std::vector<unsigned char>& out = appendCommon(EventType::Immigration, time, childId);
+        putVarint(zigzagEncode(populationId - childId), out);
+        putVarint(zigzagEncode(fromLocationId), out);
+        putVarint(zigzagEncode(toLocationId), out);
+    }
+
+    // The property name must outlive the log (a string literal), only the pointer is kept
+    void appendMutation(double time, PopulationId populationId, int locationId, const char* property,
+                        double oldValue, double newValue) {
+        uint8_t propertyIndex = internProperty(property);
+        std::vector<unsigned char>& out = appendCommon(EventType::Mutation, time, populationId);
+        putVarint(zigzagEncode(locationId), out);
+        out.push_back(propertyIndex);
+        auto oldBits = std::bit_cast<uint64_t>(oldValue);
+        for (int byte = 0; byte < 8; ++byte) {
+            out.push_back(static_cast<unsigned char>(oldBits >> (8 * byte)));
+        }
+        putXor(std::bit_cast<uint64_t>(newValue) ^ oldBits, out);
+    }
+
+    // Read the event at a cursor and move the cursor past it
+    EventRecord read(Cursor& cursor) const {
+        if (cursor.event % blockEvents == 0) {
+            const LogBlock& block = blocks[cursor.event / blockEvents];
+            cursor.chunk = block.chunk;
+            cursor.offset = block.offset;
+            cursor.previousTime = 0;
+            cursor.previousPopulation = 0;
+        } else if (cursor.offset == chunks[cursor.chunk].size()) {
+            ++cursor.chunk;
+            cursor.offset = 0;
+        }
+        const std::vector<unsigned char>& bytes = chunks[cursor.chunk];
+        BlockDecoder in(bytes.data() + cursor.offset, bytes.size() - cursor.offset);
+        cursor.previousTime += static_cast<uint64_t>(in.signedVarint());
+        uint64_t populationAndType = in.varint();
+        cursor.previousPopulation += zigzagDecode(populationAndType >> 2);
+        EventRecord record{static_cast<EventType>(populationAndType & 3), std::bit_cast<double>(cursor.previousTime),
+                           cursor.previousPopulation, -1, -1, -1, -1, 0.0, 0.0};
+        switch (record.type) {
+            case EventType::Birth:
+                record.parent = record.population + in.signedVarint();
+                record.source = in.signedVarint();
+                break;
+            case EventType::Immigration:
+                record.parent = record.population + in.signedVarint();
+                record.source = in.signedVarint();
+                record.target = in.signedVarint();
+                break;
+            case EventType::Mutation: {
+                record.source = in.signedVarint();
+                record.property = in.byte();
+                const unsigned char* raw = in.bytes(8);
+                uint64_t oldBits = 0;
+                for (int byte = 0; byte < 8; ++byte) {
+                    oldBits |= static_cast<uint64_t>(raw[byte]) << (8 * byte);
+                }
+                record.oldValue = std::bit_cast<double>(oldBits);
+                record.newValue = std::bit_cast<double>(oldBits ^ in.xorValue());
+                break;
+            }
+            case EventType::Death:
+                break;
+        }
+        cursor.offset = static_cast<size_t>(in.getPosition() - bytes.data());
+        ++cursor.event;
+        return record;
+    }
+
+    // Call f(record) for every event in order
+    template <typename F>
+    void forEach(F&& f) const {
+        Cursor cursor;
+        while (cursor.event < numEvents) {
+            f(read(cursor));
+        }
+    }
+
+    // Drop every event later than a time, events must be in time order. Only the block the cut falls into is read,
+    // the chunks emptied are kept for the events to come.
+    void discardAfter(double time) {
+        if (numEvents == 0 || std::bit_cast<double>(previousTime) <= time) {
+            return;
+        }
+        auto after = std::upper_bound(blocks.begin(), blocks.end(), time, [](double cut, const LogBlock& block) {
+            return cut < block.firstTime;
+        });
+        Cursor kept;
+        if (after != blocks.begin()) {
+            kept.event = static_cast<size_t>(after - 1 - blocks.begin()) * blockEvents;
+            for (Cursor next = kept; read(next).time <= time; next = kept) {
+                kept = next;
+            }
+        }
+
+        numEvents = kept.event;
+        blocks.resize((numEvents + blockEvents - 1) / blockEvents);
+        currentChunk = kept.chunk;
+        for (size_t chunk = currentChunk; chunk < chunks.size(); ++chunk) {
+            chunks[chunk].resize(chunk == currentChunk ? kept.offset : 0);
+        }
+        previousTime = kept.previousTime;
+        previousPopulation = kept.previousPopulation;
+    }
+
+    // Merge logs that are each in time order into one, events of equal time keep the order of the logs and within them
+    static EventLog merge(const std::vector<const EventLog*>& logs) {
+        EventLog merged;
+
+        // Earliest next event first, the lower log index on ties
+        using Head = std::pair<double, size_t>;
+        std::priority_queue<Head, std::vector<Head>, std::greater<>> heads;
+        std::vector<Cursor> cursors(logs.size());
+        std::vector<EventRecord> nextRecords(logs.size());
+        for (size_t i = 0; i < logs.size(); ++i) {
+            if (logs[i]->size() > 0) {
+                nextRecords[i] = logs[i]->read(cursors[i]);
+                heads.emplace(nextRecords[i].time, i);
+            }
+        }
+        while (!heads.empty()) {
+            size_t i = heads.top().second;
+            heads.pop();
+            const EventLog& log = *logs[i];
+            merged.appendFrom(log, nextRecords[i]);
+            if (cursors[i].event < log.size()) {
+                nextRecords[i] = log.read(cursors[i]);
+                heads.emplace(nextRecords[i].time, i);
+            }
+        }
+        return merged;
+    }
+
+    // Reserve room for a number of events, whatever their types, so appending that many never allocates. The room is
+    // taken at the worst-case size of an event, several times what events take on average.
+    void reserve(size_t events) {
+        size_t room = 0;
+        for (size_t chunk = currentChunk; chunk < chunks.size(); ++chunk) {
+            room += chunkRoom(chunk) / maxEventBytes;
+        }
+        while (room < events) {
+            size_t bytes = std::min((events - room) * maxEventBytes, maxChunkBytes);
+            chunks.emplace_back().reserve(bytes);
+            room += bytes / maxEventBytes;
+        }
+        blocks.reserve(blocks.size() + events / blockEvents + 1);
+    }
+
+    void clear() {
+        *this = EventLog();
+    }
+
+    // Get the names of the mutated properties in index order
+    [[nodiscard]] const std::vector<const char*>& getPropertyNames() const {
+        return propertyNames;
+    }
+
+    // Get the name of a mutated property from its index
+    [[nodiscard]] const char* getPropertyName(int64_t property) const {
+        return propertyNames[static_cast<size_t>(property)];
+    }
+
+    [[nodiscard]] size_t size() const {
+        return numEvents;
+    }
+
+    [[nodiscard]] bool empty() const {
+        return numEvents == 0;
+    }
+
+    // Get the memory held by the log, the full size of every chunk and spare capacity included
+    [[nodiscard]] size_t getMemoryBytes() const {
+        size_t bytes = chunks.capacity() * sizeof(std::vector<unsigned char>) + blocks.capacity() * sizeof(LogBlock);
+        for (const std::vector<unsigned char>& chunk : chunks) {
+            bytes += chunk.capacity();
+        }
+        return bytes;
+    }
+};
+
+
+#endif //FUSION_EVENT_LOG_H
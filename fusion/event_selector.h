@@ -0,0 +1,116 @@
+//
+// Created by Tianjian Qin on 10/16/2026.
+// Class definition for event selectors, which decide the waiting time and the next event from the event rates
+//
+
+#ifndef FUSION_EVENT_SELECTOR_H
+#define FUSION_EVENT_SELECTOR_H
+
+
+#include <limits>
+#include <utility>
+#include <vector>
+#include "random_service.h"
+
+// Available methods to sample the next event
+enum class SamplingMethod {
+    Direct,                 // Linear cumulative scan over all rates (Gillespie's direct method)
+    SumTree,                // Binary sum tree over all rates, logarithmic sampling and updates
+    CompositionRejection,   // Power-of-two rate groups with rejection inside a group, constant expected cost
+    NextReaction,           // Absolute firing times in an indexed min-heap, one random number per event
+    Hierarchical            // Isolation picked by its aggregate rate first, then an event within the isolation
+};
+
+// Event Selector Base Class, mirrors the rates of the rate store entry by entry
+class EventSelector {
+public:
+    static constexpr size_t npos = std::numeric_limits<size_t>::max();
+
+    virtual ~EventSelector() = default;
+
+    // Drop all rates
+    virtual void clear() = 0;
+
+    // Append the rate of a new entry at index size(), together with the isolation the event takes place on
+    virtual void add(double rate, int isolationIndex) = 0;
+
+    // Make room for a number of entries, so adding up to that many does not allocate
+    virtual void reserve(size_t numEntries) = 0;
+
+    // Change the rate of an existing entry
+    virtual void update(size_t index, double rate) = 0;
+
+    // Remove an entry, the last entry moves into its index
+    virtual void remove(size_t index) = 0;
+
+    // Get the sum of all rates
+    [[nodiscard]] virtual double getTotalRate() const = 0;
+
+    // Sample the waiting time to the next event and the index of that event (npos if nothing can happen)
+    virtual std::pair<double, size_t> sampleNext(RandomStream& random) = 0;
+};
+
+// Direct method selector, sums and scans all rates on every sample
+class DirectSelector : public EventSelector {
+private:
+    std::vector<double> rates;
+
+public:
+    void clear() override {
+        rates.clear();
+    }
+
+    void add(double rate, int) override {
+        rates.push_back(rate);
+    }
+
+    void reserve(size_t numEntries) override {
+        rates.reserve(numEntries);
+    }
+
+    void update(size_t index, double rate) override {
+        rates[index] = rate;
+    }
+
+    void remove(size_t index) override {
+        rates[index] = rates.back();
+        rates.pop_back();
+    }
+
+    [[nodiscard]] double getTotalRate() const override {
+        double totalRate = 0.0;
+        for (double rate : rates) {
+            totalRate += rate;
+        }
+        return totalRate;
+    }
+
+    std::pair<double, size_t> sampleNext(RandomStream& random) override {
+        // Compute total rate for all events
+        double totalRate = getTotalRate();
+        if (totalRate <= 0.0) {
+            return {std::numeric_limits<double>::infinity(), npos}; // Nothing can happen anymore
+        }
+
+        // Sample the waiting time for the next event (exponentially distributed)
+        double waitingTime = random.exponential(totalRate);
+
+        // Sample which event happens (based on their relative rates)
+        double threshold = random.uniform() * totalRate;
+
+        // Select event based on threshold
+        double cumulativeRate = 0.0;
+        for (size_t i = 0; i < rates.size(); ++i) {
+            cumulativeRate += rates[i];
+            if (cumulativeRate >= threshold) {
+                return {waitingTime, i};
+            }
+        }
+
+        // Rounding can leave the threshold just above the last cumulative rate
+        return {waitingTime, rates.size() - 1};
+    }
+};
+
+
+#endif //FUSION_EVENT_SELECTOR_H
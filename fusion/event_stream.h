@@ -0,0 +1,224 @@
+//
+// Created by Tianjian Qin on 10/16/2026.
+// Class definition for the event stream writer, which writes the event history to a file on a background thread while
+// the simulation runs
+//
+
+#ifndef FUSION_EVENT_STREAM_H
+#define FUSION_EVENT_STREAM_H
+
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <exception>
+#include <string>
+#include <thread>
+#include <variant>
+#include <vector>
+#include "event_log.h"
+#include "event_file.h"
+#include "compressed_event_file.h"
+#include "spsc_ring.h"
+
+// What the simulation does when the writer falls behind and the ring is full
+enum class Backpressure {
+    Block,                                  // Wait for room, nothing is lost
+    Drop,                                   // Drop the record
+    Sample                                  // Keep one in sampleInterval records once the ring is half full, drop when full
+};
+
+// Layout of the file an event stream writes
+enum class EventFileFormat {
+    Indexed,                                // Fixed-width records with Bloom filters, for EventFileReader
+    Compressed                              // Delta and varint encoded blocks, for CompressedEventFileReader
+};
+
+// Tuning of an event stream
+struct EventStreamSettings {
+    size_t ringCapacity = size_t(1) << 16;  // Records buffered between the simulation and the writer
+    size_t blockRecords = EventFileWriter::defaultBlockRecords; // Records per file block, written at once
+    Backpressure backpressure = Backpressure::Block;
+    size_t sampleInterval = 10;             // Sample: records kept under pressure are one in this many
+    EventFileFormat format = EventFileFormat::Indexed;
+    TimeEncoding timeEncoding = TimeEncoding::Delta;    // Compressed: how times are encoded
+};
+
+// Statistics of an event stream
+struct EventStreamStatistics {
+    uint64_t logged = 0;                    // Records handed to the stream
+    uint64_t written = 0;                   // Records in the file
+    uint64_t dropped = 0;                   // Records lost to a full ring
+    uint64_t sampledOut = 0;                // Records skipped by sampling
+    uint64_t blockedPushes = 0;             // Records the simulation had to wait with
+    uint64_t writes = 0;                    // Number of writes to the file
+};
+
+// The simulation thread pushes records into a single-producer single-consumer ring and a writer thread takes them out,
+// encodes them and writes them to an event file one block (with its filter, or compressed) per write. Memory is the
+// ring, one block and the block index, a few bytes per thousand records. Property names are collected on the simulation
+// side and written after the records when the stream is closed.
+class EventStreamWriter {
+private:
+    EventStreamSettings settings;
+    SpscRing<EventRecord> ring;
+    std::variant<EventFileWriter, CompressedEventFileWriter> file;  // Only touched by the writer thread till joined
+    std::thread writer;
+    std::atomic<bool> closing{false};           // Set once the simulation pushed its last record
+    std::atomic<bool> failed{false};            // Set once the writer thread stopped on an error
+    std::exception_ptr failure;                 // Error of the writer thread, read after joining it
+    EventStreamStatistics statistics;           // Counters of the simulation side
+    uint64_t sampleCounter = 0;
+    std::vector<const char*> propertyPointers;  // Property names as logged, for lookups by pointer
+    std::vector<std::string> propertyNames;     // Property names in index order
+    bool open = true;
+
+    // Create the file in the format the settings ask for
+    static std::variant<EventFileWriter, CompressedEventFileWriter> openFile(const std::string& path,
+                                                                             const EventStreamSettings& streamSettings) {
+        if (streamSettings.format == EventFileFormat::Compressed) {
+            return std::variant<EventFileWriter, CompressedEventFileWriter>(
+                    std::in_place_type<CompressedEventFileWriter>, path, streamSettings.blockRecords,
+                    streamSettings.timeEncoding);
+        }
+        return std::variant<EventFileWriter, CompressedEventFileWriter>(std::in_place_type<EventFileWriter>, path,
+                                                                        streamSettings.blockRecords);
+    }
+
+    // Body of the writer thread, sleeps a moment whenever the ring is empty. A write error stops the thread, it is kept
+    // for close() to rethrow.
+    void writeLoop() {
+        try {
+            std::visit([this](auto& writer) {
+                EventRecord record{};
+                while (true) {
+                    // Every push happens before closing is set, so a ring emptied after seeing it stays empty
+                    bool last = closing.load(std::memory_order_acquire);
+                    while (ring.pop(record)) {
+                        writer.append(record);
+                    }
+                    if (last) {
+                        break;
+                    }
+                    std::this_thread::sleep_for(std::chrono::microseconds(100));
+                }
+            }, file);
+        } catch (...) {
+            failure = std::current_exception();
+            failed.store(true, std::memory_order_release);
+        }
+    }
+
+public:
+    // Create the file and start the writer thread
+    explicit EventStreamWriter(const std::string& path, const EventStreamSettings& streamSettings = {})
+            : settings(streamSettings), ring(streamSettings.ringCapacity),
+              file(openFile(path, streamSettings)) {
+        writer = std::thread(&EventStreamWriter::writeLoop, this);
+    }
+
+    EventStreamWriter(const EventStreamWriter&) = delete;
+    EventStreamWriter& operator=(const EventStreamWriter&) = delete;
+
+    ~EventStreamWriter() {
+        if (open) {
+            try {
+                close();
+            } catch (...) {
+                // Destructors must not throw, call close() to see write errors
+            }
+        }
+    }
+
+    // Hand a record to the writer, only callable from one thread. Once the writer failed, records that find the ring
+    // full are dropped rather than waited with.
+    void push(const EventRecord& record) {
+        ++statistics.logged;
+        switch (settings.backpressure) {
+            case Backpressure::Block:
+                if (!ring.push(record)) {
+                    ++statistics.blockedPushes;
+                    while (!ring.push(record)) {
+                        if (failed.load(std::memory_order_acquire)) {
+                            ++statistics.dropped;
+                            return;
+                        }
+                        std::this_thread::yield();
+                    }
+                }
+                return;
+            case Backpressure::Sample:
+                if (ring.size() >= ring.capacity() / 2 &&
+                    sampleCounter++ % std::max<size_t>(settings.sampleInterval, 1) != 0) {
+                    ++statistics.sampledOut;
+                    return;
+                }
+                [[fallthrough]];
+            case Backpressure::Drop:
+                if (!ring.push(record)) {
+                    ++statistics.dropped;
+                }
+                return;
+        }
+    }
+
+    // Get the index of a mutated property name for the records, only callable from the pushing thread
+    int64_t propertyIndex(const char* name) {
+        for (size_t i = 0; i < propertyPointers.size(); ++i) {
+            if (propertyPointers[i] == name || propertyNames[i] == name) {
+                return static_cast<int64_t>(i);
+            }
+        }
+        propertyPointers.push_back(name);
+        propertyNames.emplace_back(name);
+        return static_cast<int64_t>(propertyNames.size() - 1);
+    }
+
+    // Wait for the writer to write everything pushed so far, then complete the file. Rethrows the error that stopped
+    // the writer thread, the file is left incomplete then.
+    EventStreamStatistics close() {
+        if (!open) {
+            return statistics;
+        }
+        open = false;
+        closing.store(true, std::memory_order_release);
+        writer.join();
+
+        std::visit([this](auto& writer) {
+            statistics.written = writer.getNumberOfRecords();
+            statistics.writes = writer.getNumberOfWrites();
+            if (!failure) {
+                writer.close(propertyNames);
+            }
+        }, file);
+        if (failure) {
+            std::rethrow_exception(failure);
+        }
+        return statistics;
+    }
+
+    // Whether the writer thread stopped on an error, close() rethrows it
+    [[nodiscard]] bool hasFailed() const {
+        return failed.load(std::memory_order_acquire);
+    }
+
+    // Get the counters of the simulation side, the written ones are only known after closing
+    [[nodiscard]] const EventStreamStatistics& getStatistics() const {
+        return statistics;
+    }
+
+    // Get the memory a stream with some settings holds, the block index and the encoding of a compressed block aside
+    [[nodiscard]] static size_t getBufferBytes(const EventStreamSettings& streamSettings) {
+        size_t ringBytes = std::bit_ceil(std::max<size_t>(streamSettings.ringCapacity, 2)) * sizeof(EventRecord);
+        if (streamSettings.format == EventFileFormat::Compressed) {
+            return ringBytes + std::max<size_t>(streamSettings.blockRecords, 1) * sizeof(EventRecord);
+        }
+        return ringBytes + std::max<size_t>(streamSettings.blockRecords, 1) * eventRecordBytes +
+               std::bit_ceil(std::max<size_t>(streamSettings.blockRecords * 2, 64));
+    }
+};
+
+
+#endif //FUSION_EVENT_STREAM_H
@@ -0,0 +1,109 @@
+//
+// Created by Tianjian Qin on 10/16/2026.
+// Class definition for the hierarchical selector, which samples an isolation first and then an event on it
+//
+
+#ifndef FUSION_HIERARCHICAL_SELECTOR_H
+#define FUSION_HIERARCHICAL_SELECTOR_H
+
+
+#include <vector>
+#include "event_selector.h"
+#include "sum_tree_selector.h"
+
+// Hierarchical selector, a top-level sum tree over the aggregate rate of every isolation and a local sum tree per
+// isolation. An update touches one local tree and one top-level leaf, whatever the size of the rest of the system.
+class HierarchicalSelector : public EventSelector {
+private:
+    // Where an entry lives
+    struct EntrySlot {
+        int isolation;                               // Isolation of the entry
+        size_t local;                                // Index in the isolation's local selector
+    };
+
+    SumTreeSelector isolationSelector;               // Aggregate rate per isolation
+    std::vector<SumTreeSelector> localSelectors;     // Per isolation rates of its events
+    std::vector<std::vector<size_t>> localEntries;   // Per isolation local index -> entry index
+    std::vector<EntrySlot> slots;                    // Per entry index
+
+    // Push the aggregate rate of an isolation to the top level
+    void refreshIsolation(int isolation) {
+        isolationSelector.update(isolation, localSelectors[isolation].getTotalRate());
+    }
+
+public:
+    void clear() override {
+        isolationSelector.clear();
+        localSelectors.clear();
+        localEntries.clear();
+        slots.clear();
+    }
+
+    void add(double rate, int isolationIndex) override {
+        while (static_cast<int>(localSelectors.size()) <= isolationIndex) {
+            localSelectors.emplace_back();
+            localEntries.emplace_back();
+            isolationSelector.add(0.0, static_cast<int>(localSelectors.size()) - 1);
+        }
+        localSelectors[isolationIndex].add(rate, isolationIndex);
+        localEntries[isolationIndex].push_back(slots.size());
+        slots.push_back({isolationIndex, localEntries[isolationIndex].size() - 1});
+        refreshIsolation(isolationIndex);
+    }
+
+    // Every isolation known so far may come to hold all entries, isolations added later start empty
+    void reserve(size_t numEntries) override {
+        slots.reserve(numEntries);
+        for (size_t isolation = 0; isolation < localSelectors.size(); ++isolation) {
+            localSelectors[isolation].reserve(numEntries);
+            localEntries[isolation].reserve(numEntries);
+        }
+    }
+
+    void update(size_t index, double rate) override {
+        const EntrySlot& slot = slots[index];
+        localSelectors[slot.isolation].update(slot.local, rate);
+        refreshIsolation(slot.isolation);
+    }
+
+    void remove(size_t index) override {
+        // Remove locally, the last local entry of the isolation moves into the freed local index
+        EntrySlot slot = slots[index];
+        auto& entries = localEntries[slot.isolation];
+        localSelectors[slot.isolation].remove(slot.local);
+        entries[slot.local] = entries.back();
+        slots[entries[slot.local]].local = slot.local;
+        entries.pop_back();
+        refreshIsolation(slot.isolation);
+
+        // Remove globally, the last entry moves into the freed index
+        size_t last = slots.size() - 1;
+        if (index != last) {
+            slots[index] = slots[last];
+            localEntries[slots[index].isolation][slots[index].local] = index;
+        }
+        slots.pop_back();
+    }
+
+    [[nodiscard]] double getTotalRate() const override {
+        return isolationSelector.getTotalRate();
+    }
+
+    std::pair<double, size_t> sampleNext(RandomStream& random) override {
+        double totalRate = getTotalRate();
+        if (totalRate <= 0.0) {
+            return {std::numeric_limits<double>::infinity(), npos}; // Nothing can happen anymore
+        }
+
+        // Sample the waiting time for the next event (exponentially distributed)
+        double waitingTime = random.exponential(totalRate);
+
+        // Pick the isolation by its aggregate rate, then the event by its rate within the isolation
+        size_t isolation = isolationSelector.find(random.uniform() * totalRate);
+        const SumTreeSelector& local = localSelectors[isolation];
+        return {waitingTime, localEntries[isolation][local.find(random.uniform() * local.getTotalRate())]};
+    }
+};
+
+
+#endif //FUSION_HIERARCHICAL_SELECTOR_H
@@ -0,0 +1,148 @@
+//
+// Created by Tianjian Qin on 10/16/2026.
+// Class definition for the id index, a compact open-addressing hash map from population ids to rows
+//
+
+#ifndef FUSION_ID_INDEX_H
+#define FUSION_ID_INDEX_H
+
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+#include "population_id.h"
+
+// Hash map from ids to positions with linear probing in one flat array of entries. A lookup touches one or two cache
+// lines, and removal shifts the following entries back instead of leaving tombstones, so a map under constant churn
+// (births and deaths) never degrades and never needs a cleanup rehash.
+class IdIndex {
+public:
+    static constexpr size_t npos = static_cast<size_t>(-1);
+
+private:
+    static constexpr PopulationId emptyKey = std::numeric_limits<PopulationId>::min();
+    static constexpr size_t minCapacity = 16;
+
+    struct Entry {
+        PopulationId key = emptyKey;
+        uint32_t position = 0;
+    };
+
+    std::vector<Entry> entries;                  // Power-of-two sized table
+    size_t count = 0;                            // Number of keys stored
+    unsigned shift = 64;                         // 64 - log2(capacity), for Fibonacci hashing
+
+    // Home bucket of a key, the multiplicative hash spreads consecutive ids over the whole table
+    [[nodiscard]] size_t bucket(PopulationId key) const {
+        return static_cast<size_t>((static_cast<uint64_t>(key) * 0x9E3779B97F4A7C15ull) >> shift);
+    }
+
+    [[nodiscard]] size_t mask() const {
+        return entries.size() - 1;
+    }
+
+    // Rebuild the table with a new power-of-two capacity
+    void rehash(size_t capacity) {
+        std::vector<Entry> old(capacity);
+        old.swap(entries);
+        shift = 64;
+        for (size_t c = capacity; c > 1; c >>= 1) {
+            --shift;
+        }
+        count = 0;
+        for (const Entry& entry : old) {
+            if (entry.key != emptyKey) {
+                insert(entry.key, entry.position);
+            }
+        }
+    }
+
+public:
+    // Insert a key or overwrite its position
+    void insert(PopulationId key, size_t position) {
+        if (key == emptyKey) {
+            throw std::invalid_argument("Id is reserved by the id index");
+        }
+        if ((count + 1) * 10 > entries.size() * 7) {   // Keep the load factor below 0.7
+            rehash(entries.empty() ? minCapacity : entries.size() * 2);
+        }
+        for (size_t i = bucket(key);; i = (i + 1) & mask()) {
+            if (entries[i].key == key) {
+                entries[i].position = static_cast<uint32_t>(position);
+                return;
+            }
+            if (entries[i].key == emptyKey) {
+                entries[i] = {key, static_cast<uint32_t>(position)};
+                ++count;
+                return;
+            }
+        }
+    }
+
+    // Get the position of a key, npos if it is not stored
+    [[nodiscard]] size_t find(PopulationId key) const {
+        if (entries.empty()) {
+            return npos;
+        }
+        for (size_t i = bucket(key);; i = (i + 1) & mask()) {
+            if (entries[i].key == key) {
+                return entries[i].position;
+            }
+            if (entries[i].key == emptyKey) {
+                return npos;
+            }
+        }
+    }
+
+    // Remove a key, returns false if it is not stored
+    bool erase(PopulationId key) {
+        if (entries.empty()) {
+            return false;
+        }
+        size_t hole = bucket(key);
+        while (entries[hole].key != key) {
+            if (entries[hole].key == emptyKey) {
+                return false;
+            }
+            hole = (hole + 1) & mask();
+        }
+
+        // Shift back every following entry of the probe run that may move into the hole, keeping all runs unbroken
+        for (size_t next = (hole + 1) & mask(); entries[next].key != emptyKey; next = (next + 1) & mask()) {
+            size_t home = bucket(entries[next].key);
+            if (((next - home) & mask()) >= ((next - hole) & mask())) {
+                entries[hole] = entries[next];
+                hole = next;
+            }
+        }
+        entries[hole] = Entry{};
+        --count;
+        return true;
+    }
+
+    // Make room for a number of keys, so inserting up to that many never rehashes
+    void reserve(size_t numKeys) {
+        size_t capacity = entries.empty() ? minCapacity : entries.size();
+        while (numKeys * 10 > capacity * 7) {
+            capacity *= 2;
+        }
+        if (capacity > entries.size()) {
+            rehash(capacity);
+        }
+    }
+
+    void clear() {
+        entries.clear();
+        count = 0;
+        shift = 64;
+    }
+
+    [[nodiscard]] size_t size() const {
+        return count;
+    }
+};
+
+
+#endif //FUSION_ID_INDEX_H
@@ -0,0 +1,132 @@
+//
+// Created by Tianjian Qin on 10/16/2026.
+// Class definition for the island engine, the groundwork shared by the parallel engines that run every island of a
+// system as its own process
+//
+
+#ifndef FUSION_ISLAND_ENGINE_H
+#define FUSION_ISLAND_ENGINE_H
+
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "system.h"
+#include "observer.h"
+#include "random_service.h"
+#include "island_process.h"
+#include "mpsc_queue.h"
+
+// Takes the islands of a system apart into processes, spreads them over worker threads with one lock-free inbox each,
+// and puts the system back together once the run is over. How the workers keep their islands in step is up to the
+// engines built on top.
+class IslandEngine {
+protected:
+    System& system;                                             // System simulated, updated when the run ends
+    Observer& observer;                                         // Receives the merged event history
+    RandomService random;                                       // Source of the island streams
+    IslandModel model;                                          // Parameters shared by the island processes
+    std::vector<std::unique_ptr<IslandProcess>> processes;      // One process per island
+    std::vector<size_t> workerOfIsland;                         // Worker owning each island
+    std::vector<std::vector<int>> islandsOfWorker;              // Islands owned by each worker
+    std::vector<std::unique_ptr<MpscQueue<IslandMessage>>> inboxes; // One inbox per worker
+    std::atomic<int64_t> inFlight{0};                           // Messages pushed but not yet taken out of an inbox
+
+    // Constructor
+    IslandEngine(System& sys, Observer& obs, const RandomService& randomService, double birthRate, double deathRate,
+                 PopulationId idBlockSize)
+            : system(sys), observer(obs), random(randomService) {
+        model.numIslands = static_cast<int>(system.getNumberOfIsolations());
+        model.baseBirthRate = birthRate;
+        model.baseDeathRate = deathRate;
+        model.idBlockSize = idBlockSize;
+        model.sparseBarriers = !system.getBarrierThresholds().isDense();
+    }
+
+    // Create one process per island continuing from the current state of the system and deal them out round-robin,
+    // returns the number of workers
+    size_t startProcesses(size_t numThreads, size_t stepsPerCheckpoint) {
+        model.firstId = system.getNextPopulationId();
+        processes.clear();
+        for (int island = 0; island < model.numIslands; ++island) {
+            processes.push_back(std::make_unique<IslandProcess>(
+                    island, model, *system.getIsolation(island), system.getBarrierThresholds().getRow(island),
+                    random.stream(IslandStreamBase + static_cast<uint32_t>(island)), stepsPerCheckpoint));
+        }
+
+        size_t numWorkers = std::clamp<size_t>(numThreads, 1, std::max(model.numIslands, 1));
+        workerOfIsland.assign(model.numIslands, 0);
+        islandsOfWorker.assign(numWorkers, {});
+        inboxes.clear();
+        for (size_t worker = 0; worker < numWorkers; ++worker) {
+            inboxes.push_back(std::make_unique<MpscQueue<IslandMessage>>());
+        }
+        for (int island = 0; island < model.numIslands; ++island) {
+            workerOfIsland[island] = static_cast<size_t>(island) % numWorkers;
+            islandsOfWorker[workerOfIsland[island]].push_back(island);
+        }
+        return numWorkers;
+    }
+
+    // Deliver the messages a process produced to the inboxes of their receivers' workers
+    void flush(IslandProcess& process) {
+        for (IslandMessage& message : process.getOutbox()) {
+            inFlight.fetch_add(1, std::memory_order_relaxed);
+            inboxes[workerOfIsland[message.receiver]]->push(std::move(message));
+        }
+        process.getOutbox().clear();
+    }
+
+    // Hand the messages waiting in a worker's inbox to their receivers
+    void drain(size_t worker) {
+        IslandMessage message;
+        while (inboxes[worker]->pop(message)) {
+            inFlight.fetch_sub(1, std::memory_order_relaxed);
+            IslandProcess& receiver = *processes[message.receiver];
+            receiver.receive(std::move(message));
+            flush(receiver);
+        }
+    }
+
+    // Drop whatever a failed run left in flight
+    void discardInFlight() {
+        IslandMessage leftover;
+        for (auto& inbox : inboxes) {
+            while (inbox->pop(leftover)) {
+                inFlight.fetch_sub(1, std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // Hand the final state back to the system and merge the histories (islands in index order), returns the number
+    // of steps the islands took
+    uint64_t finishProcesses() {
+        uint64_t steps = 0;
+        uint64_t idBlocks = 0;
+        std::vector<const Observer*> histories;
+        for (const auto& process : processes) {
+            int island = process->getIsland();
+            auto isolation = system.getIsolation(island);
+            isolation->getPopulationStore() = process->getPopulations();
+            isolation->setNicheSpaces(process->getNicheSpaces());
+            for (int other = island + 1; other < model.numIslands; ++other) {
+                if (system.getBarrierThreshold(island, other) != process->getBarriers()[other]) {
+                    system.setBarrierThreshold(island, other, process->getBarriers()[other]);
+                }
+            }
+            histories.push_back(&process->getObserver());
+            idBlocks = std::max(idBlocks, process->getIdBlocks());
+            steps += process->getSteps();
+        }
+        observer.mergeHistories(histories);
+        if (idBlocks > 0) {
+            system.reservePopulationIds(static_cast<PopulationId>(idBlocks) * model.numIslands * model.idBlockSize);
+        }
+        return steps;
+    }
+};
+
+
+#endif //FUSION_ISLAND_ENGINE_H
@@ -0,0 +1,438 @@
+//
+// Created by Tianjian Qin on 10/16/2026.
+// Class definition for island processes, single islands simulated on their own as the logical processes of the
+// parallel engines
+//
+
+#ifndef FUSION_ISLAND_PROCESS_H
+#define FUSION_ISLAND_PROCESS_H
+
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+#include "unit_population.h"
+#include "population_store.h"
+#include "population_id.h"
+#include "isolation.h"
+#include "alias_table.h"
+#include "event.h"
+#include "observer.h"
+#include "random_service.h"
+#include "rate_store.h"
+
+// Message from one island process to another, islands only interact through these
+struct IslandMessage {
+    enum class Kind : uint8_t {
+        Immigration,
+        BarrierChange
+    };
+
+    Kind kind = Kind::Immigration;
+    bool anti = false;                           // Cancels the earlier message with the same sender and serial
+    double time = 0.0;                           // Simulated time at which the message takes effect
+    int sender = -1;                             // Island sending the message
+    int receiver = -1;                           // Island receiving the message
+    uint64_t serial = 0;                         // Unique per sender
+    double threshold = 0.0;                      // New barrier between sender and receiver (barrier changes)
+    std::optional<UnitPopulation> migrant;       // Child settling on the receiver (immigrations)
+
+    // Order in which a receiver handles its messages
+    [[nodiscard]] bool before(const IslandMessage& other) const {
+        if (time != other.time) {
+            return time < other.time;
+        }
+        return sender != other.sender ? sender < other.sender : serial < other.serial;
+    }
+};
+
+// Parameters shared by the island processes of one run
+struct IslandModel {
+    int numIslands = 0;                          // Number of islands in the system
+    double baseBirthRate = 0.0;                  // Rate of births, and base of emigration rates
+    double baseDeathRate = 0.0;                  // Rate of deaths
+    PopulationId firstId = 0;                    // First id the processes may hand out
+    PopulationId idBlockSize = 4096;             // Ids taken at a time, island i takes blocks i, i + n, i + 2n, ...
+    bool sparseBarriers = false;                 // Barrier changes only touch coupled islands, as in sparse systems
+};
+
+// One island running its own exact simulation. Local events are drawn with the direct method over the event classes
+// of the model (rates only depend on the number of populations), immigrations and barrier changes towards other
+// islands leave through an outbox and arrive through receive(). Barrier changes happen at a constant rate, so their
+// times are drawn ahead and tell other islands how long the island stays uncoupled from them. States are saved every
+// few steps, so the process can roll back when a message arrives that lies in its past. Everything that decides a step
+// is part of the saved state, including the random stream, so a process handed the same messages always takes the
+// same steps.
+class IslandProcess {
+public:
+    static constexpr double never = std::numeric_limits<double>::infinity();
+
+private:
+    // Everything a rollback restores
+    struct State {
+        PopulationStore populations;             // Populations on the island
+        NicheSpaces niches;                      // Occupied and available niche space
+        std::vector<double> barriers;            // Barrier thresholds to every island (own entry unused)
+        RandomStream random;                     // Stream deciding all steps of the island
+        PopulationIdBlock ids;                   // Ids left in the current block
+        uint64_t idBlocks = 0;                   // Number of id blocks taken
+        double time = 0.0;                       // Local virtual time, of the last handled event or message
+        double nextEventTime = 0.0;              // Time of the next local event, drawn after every step
+        double nextBarrierChangeTime = 0.0;      // Time of the next barrier change, drawn after the previous one
+        uint64_t steps = 0;                      // Events and messages handled
+        double lastInputTime = -never;           // Handling order key (time, sender, serial) of the last handled
+        int lastInputSender = -1;                // message, which tells the inputs a saved state has handled even
+        uint64_t lastInputSerial = 0;            // among messages at the same time
+    };
+
+    // A message sent, remembered until the GVT passes it so a rollback can cancel it
+    struct SentMessage {
+        double time;
+        int receiver;
+        uint64_t serial;
+    };
+
+    int island;                                  // Index of the island
+    const IslandModel* model;                    // Parameters of the run
+    State state;                                 // Current state
+    std::vector<State> checkpoints;              // Saved states in time order, the first one is before the GVT
+    size_t checkpointInterval;                   // Steps between two saved states, 0 if the process never rolls back
+    size_t stepsSinceCheckpoint = 0;
+    std::vector<IslandMessage> inputs;           // Received messages in handling order
+    size_t handledInputs = 0;                    // Number of inputs handled, always a prefix of the list
+    std::vector<SentMessage> sent;               // Messages sent after the first checkpoint, in time order
+    std::vector<IslandMessage> outbox;           // Messages to deliver, emptied by the engine after every call
+    uint64_t nextSerial = 0;                     // Never rolled back, so serials stay unique
+    bool coasting = false;                       // Whether steps are replayed after a rollback, sending nothing
+    AliasTable emigrationTable;                  // Destinations weighted by 1 - barrier, follows the state
+    std::vector<double> emigrationWeights;       // Scratch row for table rebuilds
+    std::vector<double> resourceTargets;         // Availability set by a resource change
+    Observer observer;                           // Events of this island, speculative ones are dropped on rollback
+    uint64_t rollbacks = 0;                      // Number of rollbacks
+    uint64_t rolledBackSteps = 0;                // Steps undone by rollbacks
+    uint64_t antiMessages = 0;                   // Messages cancelled by rollbacks
+
+    // Rebuild the destination table of emigrants from the barrier row of the state
+    void rebuildEmigrationTable() {
+        emigrationWeights.assign(state.barriers.size(), 0.0);
+        for (size_t target = 0; target < state.barriers.size(); ++target) {
+            if (static_cast<int>(target) != island) {
+                emigrationWeights[target] = 1.0 - state.barriers[target];
+            }
+        }
+        emigrationTable.build(emigrationWeights);
+    }
+
+    // Number of inputs a state has handled, every message up to its last handled one in handling order
+    [[nodiscard]] size_t countHandledInputs(const State& saved) const {
+        IslandMessage last;
+        last.time = saved.lastInputTime;
+        last.sender = saved.lastInputSender;
+        last.serial = saved.lastInputSerial;
+        return static_cast<size_t>(
+                std::upper_bound(inputs.begin(), inputs.end(), last,
+                                 [](const IslandMessage& a, const IslandMessage& b) { return a.before(b); }) - inputs.begin());
+    }
+
+    // Sum of the rates of all local events
+    [[nodiscard]] double totalRate() const {
+        double perPopulation = model->baseBirthRate + model->baseDeathRate +
+                               model->baseBirthRate * emigrationTable.getTotalWeight();
+        return static_cast<double>(state.populations.size()) * perPopulation + EventRateStore::resourceChangeRate;
+    }
+
+    // Hand out an id from the island's own blocks, which only depend on how many ids the island took before
+    PopulationId allocateId() {
+        if (state.ids.empty()) {
+            PopulationId block = static_cast<PopulationId>(state.idBlocks * model->numIslands + island);
+            state.ids.first = model->firstId + block * model->idBlockSize;
+            state.ids.last = state.ids.first + model->idBlockSize;
+            ++state.idBlocks;
+        }
+        return state.ids.first++;
+    }
+
+    // Send a message, unless replaying steps whose messages were already sent
+    void send(IslandMessage message) {
+        if (coasting) {
+            return;
+        }
+        message.sender = island;
+        message.serial = nextSerial++;
+        if (checkpointInterval > 0) {
+            sent.push_back({message.time, message.receiver, message.serial});
+        }
+        outbox.push_back(std::move(message));
+    }
+
+    // Mutate a newcomer with the same probability the exact engine uses (the base birth rate)
+    void mutate(size_t index) {
+        if (state.random.uniform() < model->baseBirthRate) {
+            PopulationMutationEvent mutation(state.populations.at(index), state.random, model->baseBirthRate);
+            mutation.execute();
+        }
+    }
+
+    // Fire the next local event at the current time
+    void fireLocalEvent() {
+        PopulationStore& populations = state.populations;
+        double count = static_cast<double>(populations.size());
+        double births = count * model->baseBirthRate;
+        double deaths = births + count * model->baseDeathRate;
+        double emigrations = deaths + count * model->baseBirthRate * emigrationTable.getTotalWeight();
+        double pick = state.random.uniform() * totalRate();
+
+        if (pick < emigrations) {
+            size_t index = state.random.uniformIndex(populations.size());
+            PopulationId id = populations[index].getId();
+            if (pick < births) {
+                PopulationId childId = allocateId();
+                size_t childIndex = populations.addClone(populations, index, childId, island);
+                mutate(childIndex);
+                observer.logBirthEvent(state.time, id, childId, island);
+            } else if (pick < deaths) {
+                populations.remove(index);
+                observer.logDeathEvent(state.time, id);
+            } else {
+                // The child is created on the destination, mutations happen there when it arrives
+                PopulationView parent = populations[index];
+                IslandMessage message;
+                message.kind = IslandMessage::Kind::Immigration;
+                message.time = state.time;
+                message.receiver = emigrationTable.sample(state.random);
+                PopulationId childId = allocateId();
+                message.migrant.emplace(childId, message.receiver, id, parent.getMutationRate(), parent.getMobility(),
+                                        parent.getResourceUsePerNiche(), parent.getReproductivity());
+                observer.logImmigrationEvent(state.time, id, childId, island, message.receiver);
+                send(std::move(message));
+            }
+        } else {
+            state.niches.setAvailableSpaces(resourceTargets);
+        }
+    }
+
+    // Set the barriers to every other island (every coupled one with sparse barriers) at the current time and tell them
+    void changeBarriers() {
+        for (int other = 0; other < model->numIslands; ++other) {
+            if (other != island && !(model->sparseBarriers && state.barriers[other] >= 1.0)) {
+                state.barriers[other] = EventRateStore::barrierTarget;
+                IslandMessage message;
+                message.kind = IslandMessage::Kind::BarrierChange;
+                message.time = state.time;
+                message.receiver = other;
+                message.threshold = EventRateStore::barrierTarget;
+                send(std::move(message));
+            }
+        }
+        rebuildEmigrationTable();
+    }
+
+    // Apply a message at the current time
+    void handleMessage(const IslandMessage& message) {
+        if (message.kind == IslandMessage::Kind::Immigration) {
+            state.populations.add(*message.migrant);
+            mutate(state.populations.size() - 1);
+        } else {
+            state.barriers[message.sender] = message.threshold;
+            rebuildEmigrationTable();
+        }
+    }
+
+    // Return to the state right before a time: restore the latest saved state before it, cancel what was sent from
+    // that time on and replay the steps in between. Replayed steps send exactly what they sent the first time, so
+    // those messages stand. Cancelling them as well would make two islands that exchanged messages between two saved
+    // states roll each other back forever.
+    void rollback(double time) {
+        if (checkpoints.empty()) {
+            throw std::logic_error("Message in the past of an island process that cannot roll back");
+        }
+        size_t keep = checkpoints.size();
+        while (keep > 1 && checkpoints[keep - 1].time >= time) {
+            --keep;
+        }
+        checkpoints.erase(checkpoints.begin() + static_cast<std::ptrdiff_t>(keep), checkpoints.end());
+        uint64_t steps = state.steps;
+        state = checkpoints.back();
+        stepsSinceCheckpoint = 0;
+        ++rollbacks;
+
+        rebuildEmigrationTable();
+        handledInputs = countHandledInputs(state);
+        observer.discardAfter(state.time);
+        while (!sent.empty() && sent.back().time >= time) {
+            IslandMessage anti;
+            anti.anti = true;
+            anti.time = sent.back().time;
+            anti.sender = island;
+            anti.receiver = sent.back().receiver;
+            anti.serial = sent.back().serial;
+            outbox.push_back(std::move(anti));
+            sent.pop_back();
+            ++antiMessages;
+        }
+
+        coasting = true;
+        while (nextTime() < time) {
+            step();
+        }
+        coasting = false;
+        rolledBackSteps += steps - state.steps;
+    }
+
+public:
+    // Constructor, takes over the populations, niches and barrier row of an island. Without saved states
+    // (stepsPerCheckpoint = 0) the process only takes messages that do not lie in its past.
+    IslandProcess(int islandIndex, const IslandModel& islandModel, const Isolation& isolation,
+                  const std::vector<double>& barrierRow, const RandomStream& stream, size_t stepsPerCheckpoint)
+            : island(islandIndex), model(&islandModel),
+              state{isolation.getUnitPopulations(), isolation.getNicheSpaces(), barrierRow, stream, PopulationIdBlock{}, 0,
+                    0.0, 0.0, 0.0, 0, -never, -1, 0},
+              checkpointInterval(stepsPerCheckpoint),
+              resourceTargets(isolation.getNicheSpaces().getNumberOfDimensions(), EventRateStore::resourceTarget) {
+        rebuildEmigrationTable();
+        state.nextEventTime = state.random.exponential(totalRate());
+        state.nextBarrierChangeTime = state.random.exponential(EventRateStore::barrierChangeRate);
+        if (checkpointInterval > 0) {
+            saveCheckpoint();
+        }
+    }
+
+    // Time of the next step, a local event, a barrier change or the earliest message not handled yet
+    [[nodiscard]] double nextTime() const {
+        double messageTime = handledInputs < inputs.size() ? inputs[handledInputs].time : never;
+        return std::min({state.nextEventTime, state.nextBarrierChangeTime, messageTime});
+    }
+
+    // Earliest time the island may send a message, as long as no message reaches it before. Emigrants only leave
+    // with local events and only towards islands behind a barrier below 1, a pending message may change both.
+    [[nodiscard]] double earliestSend() const {
+        double time = state.nextBarrierChangeTime;
+        if (handledInputs < inputs.size()) {
+            time = std::min(time, inputs[handledInputs].time);
+        }
+        if (state.populations.size() > 0 && emigrationTable.getTotalWeight() > 0.0) {
+            time = std::min(time, state.nextEventTime);
+        }
+        return time;
+    }
+
+    // Earliest time the barrier towards another island may be below 1. Behind a barrier of 1 that takes a barrier
+    // change, one of the island's own or one of the other island's that is already waiting among the messages.
+    [[nodiscard]] double couplingTime(int other) const {
+        if (state.barriers[other] < 1.0) {
+            return state.time;
+        }
+        double time = state.nextBarrierChangeTime;
+        for (size_t index = handledInputs; index < inputs.size(); ++index) {
+            const IslandMessage& message = inputs[index];
+            if (message.kind == IslandMessage::Kind::BarrierChange && message.sender == other && message.threshold < 1.0) {
+                time = std::min(time, message.time);
+                break;
+            }
+        }
+        return time;
+    }
+
+    // Handle the earliest pending message or fire the next local event or barrier change, whichever comes first
+    void step() {
+        double localTime = std::min(state.nextEventTime, state.nextBarrierChangeTime);
+        if (handledInputs < inputs.size() && inputs[handledInputs].time <= localTime) {
+            const IslandMessage& message = inputs[handledInputs++];
+            state.time = message.time;
+            state.lastInputTime = message.time;
+            state.lastInputSender = message.sender;
+            state.lastInputSerial = message.serial;
+            handleMessage(message);
+        } else if (state.nextBarrierChangeTime < state.nextEventTime) {
+            state.time = state.nextBarrierChangeTime;
+            changeBarriers();
+            state.nextBarrierChangeTime = state.time + state.random.exponential(EventRateStore::barrierChangeRate);
+        } else {
+            state.time = state.nextEventTime;
+            fireLocalEvent();
+        }
+        ++state.steps;
+
+        // Waiting times are memoryless, so the next local event is drawn anew after every change of state
+        state.nextEventTime = state.time + state.random.exponential(totalRate());
+        if (checkpointInterval > 0 && ++stepsSinceCheckpoint >= checkpointInterval) {
+            saveCheckpoint();
+        }
+    }
+
+    // Take a message in, rolling back first if it lies in the past of the island
+    void receive(IslandMessage message) {
+        auto position = std::lower_bound(inputs.begin(), inputs.end(), message,
+                                         [](const IslandMessage& a, const IslandMessage& b) { return a.before(b); });
+        auto index = static_cast<size_t>(position - inputs.begin());
+
+        if (message.anti) {
+            if (position == inputs.end() || position->sender != message.sender || position->serial != message.serial) {
+                throw std::logic_error("Anti-message without a matching message");
+            }
+            if (index < handledInputs) {
+                rollback(message.time);
+            }
+            inputs.erase(inputs.begin() + static_cast<std::ptrdiff_t>(index));
+            return;
+        }
+
+        if (index < handledInputs || message.time <= state.time) {
+            rollback(message.time);
+        }
+        inputs.insert(inputs.begin() + static_cast<std::ptrdiff_t>(index), std::move(message));
+    }
+
+    // Save the current state
+    void saveCheckpoint() {
+        checkpoints.push_back(state);
+        stepsSinceCheckpoint = 0;
+    }
+
+    // Forget what no rollback can reach any more, nothing before the GVT is ever undone
+    void collectFossils(double gvt) {
+        if (checkpoints.empty()) {
+            inputs.erase(inputs.begin(), inputs.begin() + static_cast<std::ptrdiff_t>(handledInputs));
+            handledInputs = 0;
+            return;
+        }
+        size_t oldest = 0;
+        while (oldest + 1 < checkpoints.size() && checkpoints[oldest + 1].time < gvt) {
+            ++oldest;
+        }
+        checkpoints.erase(checkpoints.begin(), checkpoints.begin() + static_cast<std::ptrdiff_t>(oldest));
+
+        double horizon = checkpoints.front().time;
+        size_t handled = std::min(countHandledInputs(checkpoints.front()), handledInputs);
+        handledInputs -= handled;
+        inputs.erase(inputs.begin(), inputs.begin() + static_cast<std::ptrdiff_t>(handled));
+        sent.erase(sent.begin(), std::find_if(sent.begin(), sent.end(),
+                                              [horizon](const SentMessage& message) { return message.time > horizon; }));
+    }
+
+    // Get the messages produced by the last calls, to be delivered and cleared by the caller
+    [[nodiscard]] std::vector<IslandMessage>& getOutbox() {
+        return outbox;
+    }
+
+    // Getters
+    [[nodiscard]] int getIsland() const { return island; }
+    [[nodiscard]] double getTime() const { return state.time; }
+    [[nodiscard]] const PopulationStore& getPopulations() const { return state.populations; }
+    [[nodiscard]] const NicheSpaces& getNicheSpaces() const { return state.niches; }
+    [[nodiscard]] const std::vector<double>& getBarriers() const { return state.barriers; }
+    [[nodiscard]] double getNextBarrierChangeTime() const { return state.nextBarrierChangeTime; }
+    [[nodiscard]] const Observer& getObserver() const { return observer; }
+    [[nodiscard]] uint64_t getIdBlocks() const { return state.idBlocks; }
+    [[nodiscard]] uint64_t getSteps() const { return state.steps; }
+    [[nodiscard]] uint64_t getRollbacks() const { return rollbacks; }
+    [[nodiscard]] uint64_t getRolledBackSteps() const { return rolledBackSteps; }
+    [[nodiscard]] uint64_t getAntiMessages() const { return antiMessages; }
+};
+
+
+#endif //FUSION_ISLAND_PROCESS_H
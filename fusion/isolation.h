@@ -7,32 +7,79 @@
 #define FUSION_ISOLATION_H
 
 
+#include <optional>
+#include <span>
 #include <utility>
 #include <vector>
 #include <iostream>
 #include "unit_population.h"
+#include "population_store.h"
 #include "niche.h"
 
 class Isolation {
 private:
+    int isolationId;                                     // Index of this island within the system
     NicheSpaces nicheSpaces;                             // List of available and occupied spaces for all niche dimensions
-    std::vector<UnitPopulation> unitPopulations{};       // List of populations on this island
+    PopulationStore unitPopulations;                     // Populations on this island, stored column by column
 
 public:
     // Constructor
-    explicit Isolation(NicheSpaces niches)
-            : nicheSpaces(std::move(niches)) {}
+    Isolation(int id, NicheSpaces niches)
+            : isolationId(id), nicheSpaces(std::move(niches)), unitPopulations(nicheSpaces.getNumberOfDimensions()) {}
 
     // Destructor
     ~Isolation() = default;
 
-    // Add a new UnitPopulation to the island
-    void addUnitPopulation(const UnitPopulation& population) {
-        unitPopulations.push_back(population);
+    // Add a new UnitPopulation to the island, returns a handle that stays valid until it is removed
+    PopulationHandle addUnitPopulation(const UnitPopulation& population) {
+        return unitPopulations.add(population);
+    }
+
+    // Remove a UnitPopulation from the island by its id, returns false if it is not found
+    bool removeUnitPopulation(PopulationId populationId) {
+        size_t index = unitPopulations.find(populationId);
+        if (index == PopulationStore::npos) {
+            return false;
+        }
+        unitPopulations.remove(index);
+        return true;
+    }
+
+    // Remove a UnitPopulation from the island by its handle, returns false if the handle is stale
+    bool removeUnitPopulation(PopulationHandle handle) {
+        return unitPopulations.remove(handle);
+    }
+
+    // Find a UnitPopulation by its handle, returns nothing if the handle is stale
+    [[nodiscard]] std::optional<PopulationView> findUnitPopulation(PopulationHandle handle) const {
+        size_t index = unitPopulations.indexOf(handle);
+        if (index == PopulationStore::npos) {
+            return std::nullopt;
+        }
+        return unitPopulations[index];
+    }
+
+    // Find a UnitPopulation by its id, returns nothing if it is not on this island
+    [[nodiscard]] std::optional<PopulationView> findUnitPopulation(PopulationId populationId) const {
+        size_t index = unitPopulations.find(populationId);
+        if (index == PopulationStore::npos) {
+            return std::nullopt;
+        }
+        return unitPopulations[index];
+    }
+
+    // Get the island id
+    [[nodiscard]] int getId() const {
+        return isolationId;
     }
 
     // Get the list of UnitPopulations
-    [[nodiscard]] const std::vector<UnitPopulation>& getUnitPopulations() const {
+    [[nodiscard]] const PopulationStore& getUnitPopulations() const {
+        return unitPopulations;
+    }
+
+    // Get the list of UnitPopulations for in-place changes
+    [[nodiscard]] PopulationStore& getPopulationStore() {
         return unitPopulations;
     }
 
@@ -46,6 +93,16 @@ public:
         nicheSpaces = niches;
     }
 
+    // Set the occupied space of every niche dimension at once
+    void setNicheOccupancy(std::span<const double> occupied) {
+        nicheSpaces.setOccupiedSpaces(occupied);
+    }
+
+    // Set the available space of every niche dimension at once
+    void setResourceAvailability(const std::vector<double>& resources) {
+        nicheSpaces.setAvailableSpaces(resources);
+    }
+
     // Utility method to print island details
     void printDetails() const {
         std::cout << "Niche Space Details:\n";
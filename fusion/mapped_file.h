@@ -0,0 +1,92 @@
+//
+// Created by Tianjian Qin on 10/16/2026.
+// Class definition for a read-only file mapped into memory
+//
+
+#ifndef FUSION_MAPPED_FILE_H
+#define FUSION_MAPPED_FILE_H
+
+
+#include <cstddef>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#if __has_include(<sys/mman.h>)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define FUSION_MAPPED_FILE_MMAP 1
+#else
+#define FUSION_MAPPED_FILE_MMAP 0
+#endif
+
+// The contents of a file, mapped read-only so the operating system pages in what is touched. Where mmap is not
+// available the file is read into memory instead.
+class MappedFile {
+private:
+    const unsigned char* data = nullptr;
+    size_t length = 0;
+#if !FUSION_MAPPED_FILE_MMAP
+    std::vector<unsigned char> contents;
+#endif
+
+public:
+    // Map a file, throws if it cannot be opened or mapped
+    explicit MappedFile(const std::string& path) {
+#if FUSION_MAPPED_FILE_MMAP
+        int descriptor = ::open(path.c_str(), O_RDONLY);
+        if (descriptor < 0) {
+            throw std::runtime_error("Cannot open " + path);
+        }
+        struct stat status{};
+        if (fstat(descriptor, &status) != 0) {
+            ::close(descriptor);
+            throw std::runtime_error("Cannot read the size of " + path);
+        }
+        length = static_cast<size_t>(status.st_size);
+        if (length > 0) {
+            void* mapping = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, descriptor, 0);
+            if (mapping == MAP_FAILED) {
+                ::close(descriptor);
+                throw std::runtime_error("Cannot map " + path);
+            }
+            data = static_cast<const unsigned char*>(mapping);
+        }
+        ::close(descriptor);
+#else
+        std::ifstream in(path, std::ios::binary);
+        if (!in) {
+            throw std::runtime_error("Cannot open " + path);
+        }
+        contents.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+        data = contents.data();
+        length = contents.size();
+#endif
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    ~MappedFile() {
+#if FUSION_MAPPED_FILE_MMAP
+        if (data != nullptr) {
+            munmap(const_cast<unsigned char*>(data), length);
+        }
+#endif
+    }
+
+    [[nodiscard]] const unsigned char* getData() const {
+        return data;
+    }
+
+    [[nodiscard]] size_t size() const {
+        return length;
+    }
+};
+
+
+#endif //FUSION_MAPPED_FILE_H
@@ -0,0 +1,70 @@
+//
+// Created by Tianjian Qin on 10/16/2026.
+// Class definition for a lock-free multi-producer single-consumer queue, the inbox of a parallel worker
+//
+
+#ifndef FUSION_MPSC_QUEUE_H
+#define FUSION_MPSC_QUEUE_H
+
+
+#include <atomic>
+#include <optional>
+#include <utility>
+
+// Unbounded queue after Vyukov: producers swap themselves in as the head with a single atomic exchange and never wait
+// for each other or the consumer. Items of one producer come out in the order they were pushed. A push that is still
+// linking its node can hide the items behind it for a moment, so an empty pop is not a proof that nothing was sent;
+// callers count messages in flight where that matters.
+template <typename T>
+class MpscQueue {
+private:
+    struct Node {
+        std::atomic<Node*> next{nullptr};
+        std::optional<T> value;
+    };
+
+    alignas(64) std::atomic<Node*> head;         // Most recently pushed node, shared by the producers
+    alignas(64) Node* tail;                      // Consumed node in front of the oldest item, owned by the consumer
+
+public:
+    MpscQueue() {
+        Node* stub = new Node();
+        head.store(stub, std::memory_order_relaxed);
+        tail = stub;
+    }
+
+    MpscQueue(const MpscQueue&) = delete;
+    MpscQueue& operator=(const MpscQueue&) = delete;
+
+    ~MpscQueue() {
+        while (Node* next = tail->next.load(std::memory_order_relaxed)) {
+            delete tail;
+            tail = next;
+        }
+        delete tail;
+    }
+
+    // Append an item, callable from any thread
+    void push(T item) {
+        Node* node = new Node();
+        node->value.emplace(std::move(item));
+        Node* previous = head.exchange(node, std::memory_order_acq_rel);
+        previous->next.store(node, std::memory_order_release);
+    }
+
+    // Take the oldest item, only callable from the consumer thread
+    bool pop(T& item) {
+        Node* next = tail->next.load(std::memory_order_acquire);
+        if (next == nullptr) {
+            return false;
+        }
+        item = std::move(*next->value);
+        next->value.reset();
+        delete tail;
+        tail = next;
+        return true;
+    }
+};
+
+
+#endif //FUSION_MPSC_QUEUE_H
@@ -0,0 +1,176 @@
+//
+// Created by Tianjian Qin on 10/16/2026.
+// Class definition for the next reaction selector, Gibson and Bruck's method with an indexed priority queue
+//
+
+#ifndef FUSION_NEXT_REACTION_SELECTOR_H
+#define FUSION_NEXT_REACTION_SELECTOR_H
+
+
+#include <limits>
+#include <vector>
+#include "event_selector.h"
+
+// Next reaction selector, every entry keeps an absolute firing time and the earliest one fires next.
+// Only entries the rate store updates get their time recomputed, the store's incremental update plays the part of
+// the dependency graph, and a fired event is the only one that needs a fresh random number.
+class NextReactionSelector : public EventSelector {
+private:
+    static constexpr double never = std::numeric_limits<double>::infinity();
+
+    std::vector<double> rates;                   // Per entry rate
+    std::vector<double> firingTimes;             // Per entry absolute firing time
+    std::vector<size_t> heap;                    // Indexed min-heap of entry indices ordered by firing time
+    std::vector<size_t> heapPosition;            // Per entry position in the heap
+    double currentTime = 0.0;                    // Time of the last fired event
+    size_t lastFired = npos;                     // Entry that fired last and still needs a new firing time
+    RandomStream random;                         // Stream of the firing times
+
+    // Firing time drawn from scratch for a rate
+    double drawFiringTime(double rate) {
+        return rate > 0.0 ? currentTime + random.exponential(rate) : never;
+    }
+
+    void swapHeapNodes(size_t a, size_t b) {
+        std::swap(heap[a], heap[b]);
+        heapPosition[heap[a]] = a;
+        heapPosition[heap[b]] = b;
+    }
+
+    void siftUp(size_t node) {
+        while (node > 0) {
+            size_t parent = (node - 1) / 2;
+            if (firingTimes[heap[parent]] <= firingTimes[heap[node]]) {
+                break;
+            }
+            swapHeapNodes(node, parent);
+            node = parent;
+        }
+    }
+
+    void siftDown(size_t node) {
+        while (true) {
+            size_t smallest = node;
+            size_t left = 2 * node + 1;
+            size_t right = left + 1;
+            if (left < heap.size() && firingTimes[heap[left]] < firingTimes[heap[smallest]]) {
+                smallest = left;
+            }
+            if (right < heap.size() && firingTimes[heap[right]] < firingTimes[heap[smallest]]) {
+                smallest = right;
+            }
+            if (smallest == node) {
+                break;
+            }
+            swapHeapNodes(node, smallest);
+            node = smallest;
+        }
+    }
+
+    // Restore the heap order around an entry whose firing time changed
+    void reposition(size_t index) {
+        siftUp(heapPosition[index]);
+        siftDown(heapPosition[index]);
+    }
+
+public:
+    explicit NextReactionSelector(RandomStream firingTimeStream) : random(firingTimeStream) {}
+
+    void clear() override {
+        rates.clear();
+        firingTimes.clear();
+        heap.clear();
+        heapPosition.clear();
+        currentTime = 0.0;
+        lastFired = npos;
+    }
+
+    void add(double rate, int) override {
+        rates.push_back(rate);
+        firingTimes.push_back(drawFiringTime(rate));
+        heap.push_back(rates.size() - 1);
+        heapPosition.push_back(heap.size() - 1);
+        siftUp(heap.size() - 1);
+    }
+
+    void reserve(size_t numEntries) override {
+        rates.reserve(numEntries);
+        firingTimes.reserve(numEntries);
+        heap.reserve(numEntries);
+        heapPosition.reserve(numEntries);
+    }
+
+    void update(size_t index, double rate) override {
+        double oldRate = rates[index];
+        rates[index] = rate;
+        if (index == lastFired) {
+            firingTimes[index] = drawFiringTime(rate);
+            lastFired = npos;
+        } else if (oldRate > 0.0 && rate > 0.0) {
+            // Rescale the remaining waiting time instead of drawing a new one
+            firingTimes[index] = currentTime + (oldRate / rate) * (firingTimes[index] - currentTime);
+        } else {
+            firingTimes[index] = drawFiringTime(rate);
+        }
+        reposition(index);
+    }
+
+    void remove(size_t index) override {
+        size_t last = rates.size() - 1;
+        if (lastFired == index) {
+            lastFired = npos;
+        } else if (lastFired == last) {
+            lastFired = index;
+        }
+
+        // Take the entry out of the heap
+        size_t node = heapPosition[index];
+        swapHeapNodes(node, heap.size() - 1);
+        heap.pop_back();
+        if (node < heap.size()) {
+            siftUp(node);
+            siftDown(node);
+        }
+
+        // Move the last entry into the freed index
+        if (index != last) {
+            rates[index] = rates[last];
+            firingTimes[index] = firingTimes[last];
+            heapPosition[index] = heapPosition[last];
+            heap[heapPosition[index]] = index;
+        }
+        rates.pop_back();
+        firingTimes.pop_back();
+        heapPosition.pop_back();
+    }
+
+    [[nodiscard]] double getTotalRate() const override {
+        double totalRate = 0.0;
+        for (double rate : rates) {
+            totalRate += rate;
+        }
+        return totalRate;
+    }
+
+    std::pair<double, size_t> sampleNext(RandomStream&) override {
+        // The previously fired event keeps its rate unless the store updated it, either way it needs a new time
+        if (lastFired != npos) {
+            firingTimes[lastFired] = drawFiringTime(rates[lastFired]);
+            reposition(lastFired);
+            lastFired = npos;
+        }
+
+        if (heap.empty() || firingTimes[heap.front()] == never) {
+            return {never, npos}; // Nothing can happen anymore
+        }
+
+        size_t index = heap.front();
+        double waitingTime = firingTimes[index] - currentTime;
+        currentTime = firingTimes[index];
+        lastFired = index;
+        return {waitingTime, index};
+    }
+};
+
+
+#endif //FUSION_NEXT_REACTION_SELECTOR_H
@@ -6,56 +6,84 @@
 #ifndef FUSION_NICHE_H
 #define FUSION_NICHE_H
 
+#include <array>
 #include <iostream>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
-// Class representing a single niche dimension
-struct NicheDimension {
-    double occupiedSpace;
-    double availableSpace;
+// Number of niche dimensions the simulation is compiled for, 0 leaves it a runtime property
+#ifndef FUSION_NICHE_DIMENSIONS
+#define FUSION_NICHE_DIMENSIONS 3
+#endif
 
-    NicheDimension(double occupied, double available)
-            : occupiedSpace(occupied), availableSpace(available) {}
-};
+inline constexpr size_t dynamicNiches = 0;
+inline constexpr size_t nicheDimensions = FUSION_NICHE_DIMENSIONS;
+
+// One value per niche dimension, a fixed array when the number of dimensions is known at compile time
+template <typename T, size_t N>
+using NicheArray = std::conditional_t<N == dynamicNiches, std::vector<T>, std::array<T, N>>;
 
-// Class representing multiple niche dimensions
-class NicheSpaces {
+// Class representing multiple niche dimensions, occupied and available space are kept as two dense rows
+template <size_t N>
+class BasicNicheSpaces {
 private:
-    std::vector<NicheDimension> dimensions;
+    NicheArray<double, N> occupiedSpaces{};
+    NicheArray<double, N> availableSpaces{};
 
 public:
-    // Constructor
-    NicheSpaces(const std::vector<std::pair<double, double>>& niches) {
-        for (const auto& niche : niches) {
-            dimensions.emplace_back(niche.first, niche.second);
+    // Constructor, a fixed number of dimensions must match the number of niches given
+    BasicNicheSpaces(const std::vector<std::pair<double, double>>& niches) {
+        if constexpr (N == dynamicNiches) {
+            occupiedSpaces.resize(niches.size());
+            availableSpaces.resize(niches.size());
+        } else if (niches.size() != N) {
+            throw std::invalid_argument("Expected " + std::to_string(N) + " niche dimensions");
+        }
+        for (size_t i = 0; i < niches.size(); ++i) {
+            occupiedSpaces[i] = niches[i].first;
+            availableSpaces[i] = niches[i].second;
         }
     }
 
     // Get the number of niche dimensions
-    [[nodiscard]] size_t getNumberOfDimensions() const {
-        return dimensions.size();
+    [[nodiscard]] constexpr size_t getNumberOfDimensions() const {
+        return occupiedSpaces.size();
     }
 
     // Get occupied space for a specific dimension
     [[nodiscard]] double getOccupiedSpace(size_t index) const {
-        if (index < dimensions.size()) {
-            return dimensions[index].occupiedSpace;
+        if (index < getNumberOfDimensions()) {
+            return occupiedSpaces[index];
         }
         throw std::out_of_range("Index out of bounds");
     }
 
     // Get available space for a specific dimension
     [[nodiscard]] double getAvailableSpace(size_t index) const {
-        if (index < dimensions.size()) {
-            return dimensions[index].availableSpace;
+        if (index < getNumberOfDimensions()) {
+            return availableSpaces[index];
         }
         throw std::out_of_range("Index out of bounds");
     }
 
+    // Get the occupied space of all dimensions
+    [[nodiscard]] std::span<const double> getOccupiedSpaces() const {
+        return occupiedSpaces;
+    }
+
+    // Get the available space of all dimensions
+    [[nodiscard]] std::span<const double> getAvailableSpaces() const {
+        return availableSpaces;
+    }
+
     // Set occupied space for a specific dimension
     void setOccupiedSpace(size_t index, double occupied) {
-        if (index < dimensions.size()) {
-            dimensions[index].occupiedSpace = occupied;
+        if (index < getNumberOfDimensions()) {
+            occupiedSpaces[index] = occupied;
         } else {
             throw std::out_of_range("Index out of bounds");
         }
@@ -63,22 +91,39 @@ public:
 
     // Set available space for a specific dimension
     void setAvailableSpace(size_t index, double available) {
-        if (index < dimensions.size()) {
-            dimensions[index].availableSpace = available;
+        if (index < getNumberOfDimensions()) {
+            availableSpaces[index] = available;
         } else {
             throw std::out_of_range("Index out of bounds");
         }
     }
 
+    // Set the occupied space of all dimensions at once, extra values are ignored
+    void setOccupiedSpaces(std::span<const double> occupied) {
+        for (size_t i = 0; i < occupied.size() && i < getNumberOfDimensions(); ++i) {
+            occupiedSpaces[i] = occupied[i];
+        }
+    }
+
+    // Set the available space of all dimensions at once, extra values are ignored
+    void setAvailableSpaces(std::span<const double> available) {
+        for (size_t i = 0; i < available.size() && i < getNumberOfDimensions(); ++i) {
+            availableSpaces[i] = available[i];
+        }
+    }
+
     // Print details of the niche dimensions
     void printDetails() const {
         std::cout << "Niche Dimensions:\n";
-        for (size_t i = 0; i < dimensions.size(); ++i) {
-            std::cout << "Dimension " << i << ": Occupied Space = " << dimensions[i].occupiedSpace
-                      << ", Available Space = " << dimensions[i].availableSpace << std::endl;
+        for (size_t i = 0; i < getNumberOfDimensions(); ++i) {
+            std::cout << "Dimension " << i << ": Occupied Space = " << occupiedSpaces[i]
+                      << ", Available Space = " << availableSpaces[i] << std::endl;
         }
     }
 };
 
+// Niche spaces with the number of dimensions the simulation is compiled for
+using NicheSpaces = BasicNicheSpaces<nicheDimensions>;
+
 
 #endif //FUSION_NICHE_H
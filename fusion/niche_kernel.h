@@ -0,0 +1,255 @@
+//
+// Created by Tianjian Qin on 10/16/2026.
+// Class definition for the niche competition kernel, which turns an island's resource use into occupancy and rates
+//
+
+#ifndef FUSION_NICHE_KERNEL_H
+#define FUSION_NICHE_KERNEL_H
+
+
+#include <algorithm>
+#include <cstddef>
+#include <span>
+#include <vector>
+#include "niche.h"
+#include "simd.h"
+
+// Niche competition on one island. Occupancy of a niche axis is the summed resource use of all populations on it, its
+// saturation is occupancy over available space. A population's crowding is the saturation of the niches it uses,
+// weighted by its use of them, and scales its rates: birth = base * max(0, 1 - crowding), death = base * (1 + crowding).
+// The SIMD paths sum in a different order than the scalar one, so results agree to rounding only. The scalar level is
+// the default so seeded runs are bit-identical across machines; opt into a vector level where they need not be.
+template <size_t N>
+class BasicNicheCompetitionKernel {
+private:
+    static constexpr size_t maxVectorNiches = 16;    // Widest rows the SIMD paths handle, wider ones run scalar
+
+    SimdLevel level = SimdLevel::Scalar;             // Instruction set in use
+    std::vector<double> saturation;                  // Scratch, saturation per niche axis
+
+    // Number of niche axes, a constant unless N is dynamic
+    static size_t nicheCount(size_t numNiches) {
+        if constexpr (N == dynamicNiches) {
+            return numNiches;
+        } else {
+            return N;
+        }
+    }
+
+    static void occupancyScalar(const double* use, size_t numPopulations, size_t numNiches, double* occupied) {
+        const size_t niches = nicheCount(numNiches);
+        std::fill(occupied, occupied + niches, 0.0);
+        for (size_t p = 0; p < numPopulations; ++p) {
+            for (size_t k = 0; k < niches; ++k) {
+                occupied[k] += use[p * niches + k];
+            }
+        }
+    }
+
+    static void ratesScalar(const double* use, size_t begin, size_t numPopulations, size_t numNiches,
+                            const double* saturationPerNiche, double baseBirthRate, double baseDeathRate,
+                            double* birthRates, double* deathRates) {
+        const size_t niches = nicheCount(numNiches);
+        for (size_t p = begin; p < numPopulations; ++p) {
+            double weighted = 0.0;
+            double totalUse = 0.0;
+            for (size_t k = 0; k < niches; ++k) {
+                weighted += use[p * niches + k] * saturationPerNiche[k];
+                totalUse += use[p * niches + k];
+            }
+            double crowding = totalUse > 0.0 ? weighted / totalUse : 0.0;
+            birthRates[p] = baseBirthRate * std::max(0.0, 1.0 - crowding);
+            deathRates[p] = baseDeathRate * (1.0 + crowding);
+        }
+    }
+
+#if FUSION_X86_SIMD
+    // The resource use matrix is walked as a flat array in blocks of Lanes whole rows, which is also a whole number of
+    // vectors. Lane l of vector v in a block then always holds niche (Lanes * v + l) % niches, so one accumulator per
+    // vector position is enough and the lanes are folded onto their niches once at the end.
+    __attribute__((target("avx2")))
+    static void occupancyAvx2(const double* use, size_t numPopulations, size_t numNiches, double* occupied) {
+        const size_t niches = nicheCount(numNiches);
+        std::fill(occupied, occupied + niches, 0.0);
+
+        __m256d accumulators[N == dynamicNiches ? maxVectorNiches : N];
+        for (size_t v = 0; v < niches; ++v) {
+            accumulators[v] = _mm256_setzero_pd();
+        }
+        const size_t total = numPopulations * niches;
+        const size_t block = 4 * niches;
+        size_t j = 0;
+        for (; j + block <= total; j += block) {
+            for (size_t v = 0; v < niches; ++v) {
+                accumulators[v] = _mm256_add_pd(accumulators[v], _mm256_loadu_pd(use + j + 4 * v));
+            }
+        }
+
+        alignas(32) double lanes[4];
+        for (size_t v = 0; v < niches; ++v) {
+            _mm256_store_pd(lanes, accumulators[v]);
+            for (size_t l = 0; l < 4; ++l) {
+                occupied[(4 * v + l) % niches] += lanes[l];
+            }
+        }
+        for (; j < total; ++j) {
+            occupied[j % niches] += use[j];     // Rows left over after the last block
+        }
+    }
+
+    // Four populations per iteration, their values of one niche are gathered with the row width as stride
+    __attribute__((target("avx2")))
+    static void ratesAvx2(const double* use, size_t numPopulations, size_t numNiches, const double* saturationPerNiche,
+                          double baseBirthRate, double baseDeathRate, double* birthRates, double* deathRates) {
+        const size_t niches = nicheCount(numNiches);
+        const auto stride = static_cast<int>(niches);
+        const __m128i rowOffsets = _mm_setr_epi32(0, stride, 2 * stride, 3 * stride);
+        const __m256d zero = _mm256_setzero_pd();
+        const __m256d one = _mm256_set1_pd(1.0);
+        const __m256d birthBase = _mm256_set1_pd(baseBirthRate);
+        const __m256d deathBase = _mm256_set1_pd(baseDeathRate);
+        const __m256d allLanes = _mm256_castsi256_pd(_mm256_set1_epi64x(-1));
+
+        size_t p = 0;
+        for (; p + 4 <= numPopulations; p += 4) {
+            __m256d weighted = zero;
+            __m256d totalUse = zero;
+            for (size_t k = 0; k < niches; ++k) {
+                __m256d values = _mm256_mask_i32gather_pd(zero, use + p * niches + k, rowOffsets, allLanes, 8);
+                weighted = _mm256_add_pd(weighted, _mm256_mul_pd(values, _mm256_set1_pd(saturationPerNiche[k])));
+                totalUse = _mm256_add_pd(totalUse, values);
+            }
+            __m256d used = _mm256_cmp_pd(totalUse, zero, _CMP_GT_OQ);
+            __m256d crowding = _mm256_and_pd(used, _mm256_div_pd(weighted, _mm256_blendv_pd(one, totalUse, used)));
+            _mm256_storeu_pd(birthRates + p, _mm256_mul_pd(birthBase, _mm256_max_pd(zero, _mm256_sub_pd(one, crowding))));
+            _mm256_storeu_pd(deathRates + p, _mm256_mul_pd(deathBase, _mm256_add_pd(one, crowding)));
+        }
+        ratesScalar(use, p, numPopulations, numNiches, saturationPerNiche, baseBirthRate, baseDeathRate, birthRates, deathRates);
+    }
+
+    __attribute__((target("avx512f")))
+    static void occupancyAvx512(const double* use, size_t numPopulations, size_t numNiches, double* occupied) {
+        const size_t niches = nicheCount(numNiches);
+        std::fill(occupied, occupied + niches, 0.0);
+
+        __m512d accumulators[N == dynamicNiches ? maxVectorNiches : N];
+        for (size_t v = 0; v < niches; ++v) {
+            accumulators[v] = _mm512_setzero_pd();
+        }
+        const size_t total = numPopulations * niches;
+        const size_t block = 8 * niches;
+        size_t j = 0;
+        for (; j + block <= total; j += block) {
+            for (size_t v = 0; v < niches; ++v) {
+                accumulators[v] = _mm512_add_pd(accumulators[v], _mm512_loadu_pd(use + j + 8 * v));
+            }
+        }
+
+        alignas(64) double lanes[8];
+        for (size_t v = 0; v < niches; ++v) {
+            _mm512_store_pd(lanes, accumulators[v]);
+            for (size_t l = 0; l < 8; ++l) {
+                occupied[(8 * v + l) % niches] += lanes[l];
+            }
+        }
+        for (; j < total; ++j) {
+            occupied[j % niches] += use[j];
+        }
+    }
+
+    __attribute__((target("avx512f")))
+    static void ratesAvx512(const double* use, size_t numPopulations, size_t numNiches, const double* saturationPerNiche,
+                            double baseBirthRate, double baseDeathRate, double* birthRates, double* deathRates) {
+        const size_t niches = nicheCount(numNiches);
+        const auto stride = static_cast<int>(niches);
+        const __m256i rowOffsets = _mm256_setr_epi32(0, stride, 2 * stride, 3 * stride, 4 * stride, 5 * stride,
+                                                     6 * stride, 7 * stride);
+        const __m512d zero = _mm512_setzero_pd();
+        const __m512d one = _mm512_set1_pd(1.0);
+        const __m512d birthBase = _mm512_set1_pd(baseBirthRate);
+        const __m512d deathBase = _mm512_set1_pd(baseDeathRate);
+
+        size_t p = 0;
+        for (; p + 8 <= numPopulations; p += 8) {
+            __m512d weighted = zero;
+            __m512d totalUse = zero;
+            for (size_t k = 0; k < niches; ++k) {
+                __m512d values = _mm512_mask_i32gather_pd(zero, 0xFF, rowOffsets, use + p * niches + k, 8);
+                weighted = _mm512_add_pd(weighted, _mm512_mul_pd(values, _mm512_set1_pd(saturationPerNiche[k])));
+                totalUse = _mm512_add_pd(totalUse, values);
+            }
+            __mmask8 used = _mm512_cmp_pd_mask(totalUse, zero, _CMP_GT_OQ);
+            __m512d crowding = _mm512_mask_div_pd(zero, used, weighted, totalUse);
+            __m512d room = _mm512_sub_pd(one, crowding);
+            room = _mm512_mask_blend_pd(_mm512_cmp_pd_mask(room, zero, _CMP_GT_OQ), zero, room);
+            _mm512_storeu_pd(birthRates + p, _mm512_mul_pd(birthBase, room));
+            _mm512_storeu_pd(deathRates + p, _mm512_mul_pd(deathBase, _mm512_add_pd(one, crowding)));
+        }
+        ratesScalar(use, p, numPopulations, numNiches, saturationPerNiche, baseBirthRate, baseDeathRate, birthRates, deathRates);
+    }
+#endif
+
+public:
+    [[nodiscard]] SimdLevel getSimdLevel() const {
+        return level;
+    }
+
+    // Choose the instruction set, capped at what the CPU supports. Vector levels make rates, and with them seeded runs,
+    // depend on the CPU.
+    void setSimdLevel(SimdLevel simdLevel) {
+        level = std::min(simdLevel, detectSimdLevel());
+    }
+
+    // Compute the occupancy of every niche axis from a row-major resource use matrix (one row of numNiches values per
+    // population), then the crowding-scaled birth and death rate of every population. The outputs must hold numNiches
+    // and numPopulations values respectively.
+    void run(std::span<const double> resourceUse, size_t numPopulations, size_t numNiches,
+             std::span<const double> availableSpace, double baseBirthRate, double baseDeathRate,
+             std::span<double> occupiedSpace, std::span<double> birthRates, std::span<double> deathRates) {
+        const size_t niches = nicheCount(numNiches);
+        SimdLevel effective = niches <= maxVectorNiches ? level : SimdLevel::Scalar;
+
+        switch (effective) {
+#if FUSION_X86_SIMD
+            case SimdLevel::AVX512:
+                occupancyAvx512(resourceUse.data(), numPopulations, niches, occupiedSpace.data());
+                break;
+            case SimdLevel::AVX2:
+                occupancyAvx2(resourceUse.data(), numPopulations, niches, occupiedSpace.data());
+                break;
+#endif
+            default:
+                occupancyScalar(resourceUse.data(), numPopulations, niches, occupiedSpace.data());
+                break;
+        }
+
+        // A niche without space counts as saturated
+        saturation.resize(niches);
+        for (size_t k = 0; k < niches; ++k) {
+            saturation[k] = availableSpace[k] > 0.0 ? occupiedSpace[k] / availableSpace[k] : 1.0;
+        }
+
+        switch (effective) {
+#if FUSION_X86_SIMD
+            case SimdLevel::AVX512:
+                ratesAvx512(resourceUse.data(), numPopulations, niches, saturation.data(), baseBirthRate, baseDeathRate,
+                            birthRates.data(), deathRates.data());
+                break;
+            case SimdLevel::AVX2:
+                ratesAvx2(resourceUse.data(), numPopulations, niches, saturation.data(), baseBirthRate, baseDeathRate,
+                          birthRates.data(), deathRates.data());
+                break;
+#endif
+            default:
+                ratesScalar(resourceUse.data(), 0, numPopulations, niches, saturation.data(), baseBirthRate, baseDeathRate,
+                            birthRates.data(), deathRates.data());
+                break;
+        }
+    }
+};
+
+// Kernel for the number of niche dimensions the simulation is compiled for
+using NicheCompetitionKernel = BasicNicheCompetitionKernel<nicheDimensions>;
+
+
+#endif //FUSION_NICHE_KERNEL_H
@@ -7,70 +7,206 @@
 #define FUSION_OBSERVER_H
 
 
+#include <memory>
+#include <stdexcept>
 #include <string>
 #include <vector>
 #include <iostream>
-#include <memory>
+#include "event_log.h"
+#include "event_file.h"
+#include "compressed_event_file.h"
+#include "event_stream.h"
 
 class Observer {
 private:
-    struct EventRecord {
-        std::string eventType;          // Event type name (birth, death, immigration, mutation, etc.)
-        double eventTime;               // Time at which the event occurred
-        std::string eventDetails;       // Additional details about the event
+    EventLog eventHistory;                       // All historical events, compactly encoded
+    std::unique_ptr<EventStreamWriter> stream;   // File the events go to instead while streaming
 
-        EventRecord(const std::string& type, double time, const std::string& details)
-                : eventType(type), eventTime(time), eventDetails(details) {}
-    };
+    // Name of an event type as it appears in the written history
+    static const char* typeName(EventType type) {
+        switch (type) {
+            case EventType::Birth:
+                return "Birth";
+            case EventType::Death:
+                return "Death";
+            case EventType::Immigration:
+                return "Immigration";
+            case EventType::Mutation:
+                return "Mutation";
+        }
+        return "Unknown";
+    }
 
-    std::vector<EventRecord> eventHistory; // Vector to store all historical event records
+    // Format the additional details of a record
+    std::string formatDetails(const EventRecord& record) const {
+        switch (record.type) {
+            case EventType::Birth:
+                return "Parent ID: " + std::to_string(record.parent) +
+                       ", Child ID: " + std::to_string(record.population) +
+                       ", Location ID: " + std::to_string(record.source);
+            case EventType::Death:
+                return "Population ID: " + std::to_string(record.population);
+            case EventType::Immigration:
+                return "Population ID: " + std::to_string(record.parent) +
+                       ", From Location: " + std::to_string(record.source) +
+                       ", To Location: " + std::to_string(record.target);
+            case EventType::Mutation:
+                return "Population ID: " + std::to_string(record.population) +
+                       ", Location ID: " + std::to_string(record.source) +
+                       ", Mutated Property: " + eventHistory.getPropertyName(record.property) +
+                       ", From Value: " + std::to_string(record.oldValue) +
+                       ", To Value: " + std::to_string(record.newValue);
+        }
+        return "";
+    }
 
 public:
+    Observer() = default;
+
+    // Copies take the history but not the stream, which belongs to the observer that opened it
+    Observer(const Observer& other) : eventHistory(other.eventHistory) {}
+
+    Observer& operator=(const Observer& other) {
+        if (this != &other) {
+            eventHistory = other.eventHistory;
+        }
+        return *this;
+    }
+
+    Observer(Observer&&) noexcept = default;
+    Observer& operator=(Observer&&) noexcept = default;
+
     // Log a birth event (with parent and child population details)
-    void logBirthEvent(double time, int parentId, int childId, int locationId) {
-        std::string details = "Parent ID: " + std::to_string(parentId) +
-                              ", Child ID: " + std::to_string(childId) +
-                              ", Location ID: " + std::to_string(locationId);
-        eventHistory.emplace_back("Birth", time, details);
+    void logBirthEvent(double time, PopulationId parentId, PopulationId childId, int locationId) {
+        if (stream) {
+            stream->push({EventType::Birth, time, childId, parentId, locationId, -1, -1, 0.0, 0.0});
+            return;
+        }
+        eventHistory.appendBirth(time, parentId, childId, locationId);
     }
 
     // Log a death event (with the population id that died)
-    void logDeathEvent(double time, int populationId) {
-        std::string details = "Population ID: " + std::to_string(populationId);
-        eventHistory.emplace_back("Death", time, details);
+    void logDeathEvent(double time, PopulationId populationId) {
+        if (stream) {
+            stream->push({EventType::Death, time, populationId, -1, -1, -1, -1, 0.0, 0.0});
+            return;
+        }
+        eventHistory.appendDeath(time, populationId);
+    }
+
+    // Log an immigration event (with the emigrating population, the id of its copy on the destination, from location,
+    // and to location)
+    void logImmigrationEvent(double time, PopulationId populationId, PopulationId childId, int fromLocationId,
+                             int toLocationId) {
+        if (stream) {
+            stream->push({EventType::Immigration, time, childId, populationId, fromLocationId, toLocationId, -1, 0.0, 0.0});
+            return;
+        }
+        eventHistory.appendImmigration(time, populationId, childId, fromLocationId, toLocationId);
+    }
+
+    // Log a mutation event (with population id, location, mutated property and values), the property name must be a
+    // string literal as only the pointer is kept
+    void logMutationEvent(double time, PopulationId populationId, int locationId,
+                          const char* property, double oldValue, double newValue) {
+        if (stream) {
+            stream->push({EventType::Mutation, time, populationId, -1, locationId, -1, stream->propertyIndex(property),
+                          oldValue, newValue});
+            return;
+        }
+        eventHistory.appendMutation(time, populationId, locationId, property, oldValue, newValue);
     }
 
-    // Log an immigration event (with population id, from location, and to location)
-    void logImmigrationEvent(double time, int populationId, int fromLocationId, int toLocationId) {
-        std::string details = "Population ID: " + std::to_string(populationId) +
-                              ", From Location: " + std::to_string(fromLocationId) +
-                              ", To Location: " + std::to_string(toLocationId);
-        eventHistory.emplace_back("Immigration", time, details);
+    // Send every event logged from now on to a file, written on a background thread, instead of keeping it in memory
+    void streamTo(const std::string& path, const EventStreamSettings& settings = {}) {
+        closeStream();
+        stream = std::make_unique<EventStreamWriter>(path, settings);
     }
 
-    // Log a mutation event (with population id, location, mutated property and values)
-    void logMutationEvent(double time, int populationId, int locationId,
-                          const std::string& property, double oldValue, double newValue) {
-        std::string details = "Population ID: " + std::to_string(populationId) +
-                              ", Location ID: " + std::to_string(locationId) +
-                              ", Mutated Property: " + property +
-                              ", From Value: " + std::to_string(oldValue) +
-                              ", To Value: " + std::to_string(newValue);
-        eventHistory.emplace_back("Mutation", time, details);
+    // Write out whatever is still buffered and complete the file, later events are kept in memory again
+    EventStreamStatistics closeStream() {
+        if (!stream) {
+            return {};
+        }
+        std::unique_ptr<EventStreamWriter> closed = std::move(stream);
+        return closed->close();
+    }
+
+    [[nodiscard]] bool isStreaming() const {
+        return stream != nullptr;
+    }
+
+    // Drop every record later than a time, for engines that roll back speculatively executed events (records must be
+    // in time order)
+    void discardAfter(double time) {
+        if (stream) {
+            throw std::logic_error("Events already streamed to a file cannot be rolled back");
+        }
+        eventHistory.discardAfter(time);
+    }
+
+    // Merge the histories of other observers into this one by time, records of equal time keep the order of the
+    // observers (this one first) and within them. Every history must be in time order. While streaming, the merged
+    // events of the others are appended to the stream.
+    void mergeHistories(const std::vector<const Observer*>& observers) {
+        std::vector<const EventLog*> logs;
+        if (!stream) {
+            logs.push_back(&eventHistory);
+        }
+        for (const Observer* other : observers) {
+            logs.push_back(&other->eventHistory);
+        }
+        EventLog merged = EventLog::merge(logs);
+        if (!stream) {
+            eventHistory = std::move(merged);
+            return;
+        }
+        merged.forEach([&](EventRecord record) {
+            if (record.type == EventType::Mutation) {
+                record.property = stream->propertyIndex(merged.getPropertyName(record.property));
+            }
+            stream->push(record);
+        });
     }
 
     // Get the entire event history for further processing
-    const std::vector<EventRecord>& getEventHistory() const {
+    const EventLog& getEventHistory() const {
         return eventHistory;
     }
 
+    // Write all logged events to a stream
+    void writeEventHistory(std::ostream& out) const {
+        out << "Event History:\n";
+        eventHistory.forEach([&](const EventRecord& record) {
+            out << "Time: " << record.time << " | Type: " << typeName(record.type)
+                << " | Details: " << formatDetails(record) << "\n";
+        });
+    }
+
+    // Write all logged events to an event file, for random access with EventFileReader
+    void writeEventLog(const std::string& path) const {
+        EventFileWriter writer(path);
+        eventHistory.forEach([&writer](const EventRecord& record) { writer.append(record); });
+        const std::vector<const char*>& names = eventHistory.getPropertyNames();
+        writer.close(std::vector<std::string>(names.begin(), names.end()));
+    }
+
+    // Write all logged events to a compressed event file, for CompressedEventFileReader
+    void writeCompressedEventLog(const std::string& path, TimeEncoding timeEncoding = TimeEncoding::Delta) const {
+        CompressedEventFileWriter writer(path, CompressedEventFileWriter::defaultBlockRecords, timeEncoding);
+        eventHistory.forEach([&writer](const EventRecord& record) { writer.append(record); });
+        const std::vector<const char*>& names = eventHistory.getPropertyNames();
+        writer.close(std::vector<std::string>(names.begin(), names.end()));
+    }
+
     // Print all logged events (can be replaced by more advanced data handling or exporting)
     void printEventHistory() const {
-        std::cout << "Event History:\n";
-        for (const auto& record : eventHistory) {
-            std::cout << "Time: " << record.eventTime << " | Type: " << record.eventType
-                      << " | Details: " << record.eventDetails << "\n";
-        }
+        writeEventHistory(std::cout);
+    }
+
+    // Reserve room in the event history for a number of events
+    void reserveHistory(size_t numEvents) {
+        eventHistory.reserve(numEvents);
     }
 
     // Clear event history (optional, for resetting the observer)
@@ -0,0 +1,94 @@
+//
+// Created by Tianjian Qin on 10/16/2026.
+// Definitions for population ids and the allocator handing them out
+//
+
+#ifndef FUSION_POPULATION_ID_H
+#define FUSION_POPULATION_ID_H
+
+
+#include <atomic>
+#include <cstdint>
+#include <stdexcept>
+
+// Unique id of a population, 64 bits wide as long runs spawn more than 2^31 populations
+using PopulationId = int64_t;
+
+// Range [first, last) of ids reserved in one go
+struct PopulationIdBlock {
+    PopulationId first = 0;
+    PopulationId last = 0;
+
+    [[nodiscard]] bool empty() const { return first == last; }
+};
+
+// Hands out unique population ids from a single atomic counter. Single ids are taken one by one, parallel workers
+// reserve whole blocks instead and draw from them without touching the shared counter again. Ids only depend on the
+// order of the calls, so as long as blocks are reserved in a fixed order (e.g. by the coordinating thread, island by
+// island) a replay hands out exactly the same ids.
+class PopulationIdAllocator {
+private:
+    std::atomic<PopulationId> next;              // Next id not yet handed out
+
+public:
+    explicit PopulationIdAllocator(PopulationId first = 0) : next(first) {}
+
+    // Copying takes over the position of the counter, a copy continues where the original stood
+    PopulationIdAllocator(const PopulationIdAllocator& other) : next(other.peek()) {}
+
+    PopulationIdAllocator& operator=(const PopulationIdAllocator& other) {
+        next.store(other.peek(), std::memory_order_relaxed);
+        return *this;
+    }
+
+    // Hand out a single id
+    PopulationId allocate() {
+        return next.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // Reserve a block of consecutive ids
+    PopulationIdBlock reserve(PopulationId count) {
+        if (count <= 0) {
+            throw std::invalid_argument("Id blocks must hold at least one id");
+        }
+        PopulationId first = next.fetch_add(count, std::memory_order_relaxed);
+        return {first, first + count};
+    }
+
+    // Get the id the next allocation would return
+    [[nodiscard]] PopulationId peek() const {
+        return next.load(std::memory_order_relaxed);
+    }
+};
+
+// Per-worker source of ids drawing from reserved blocks, only touches the shared allocator when a block runs out
+class PopulationIdCursor {
+private:
+    PopulationIdAllocator* allocator;            // Shared allocator the blocks come from
+    PopulationId blockSize;                      // Number of ids reserved at a time
+    PopulationIdBlock block;                     // Ids left in the current block
+
+public:
+    PopulationIdCursor(PopulationIdAllocator& ids, PopulationId size) : allocator(&ids), blockSize(size) {}
+
+    // Hand out the next id, reserving a new block first if the current one is used up
+    PopulationId allocate() {
+        if (block.empty()) {
+            block = allocator->reserve(blockSize);
+        }
+        return block.first++;
+    }
+
+    // Replace the remaining ids with a block reserved elsewhere, e.g. handed out by a coordinator in a fixed order
+    void assign(PopulationIdBlock reserved) {
+        block = reserved;
+    }
+
+    // Get the number of ids left before the next reservation
+    [[nodiscard]] PopulationId remaining() const {
+        return block.last - block.first;
+    }
+};
+
+
+#endif //FUSION_POPULATION_ID_H
@@ -0,0 +1,385 @@
+//
+// Created by Tianjian Qin on 10/16/2026.
+// Class definitions for the population store, a structure-of-arrays container of the populations on one island
+//
+
+#ifndef FUSION_POPULATION_STORE_H
+#define FUSION_POPULATION_STORE_H
+
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <iterator>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "id_index.h"
+#include "niche.h"
+#include "unit_population.h"
+
+// Stable reference to a population in a store. Rows move when others are removed, a handle keeps pointing to the
+// same population and goes stale once it is removed, as the generation of its slot no longer matches.
+struct PopulationHandle {
+    static constexpr uint32_t nullSlot = UINT32_MAX;
+
+    uint32_t slot = nullSlot;           // Slot in the store's handle table
+    uint32_t generation = 0;            // Generation of the slot when the handle was given out
+
+    [[nodiscard]] bool isNull() const { return slot == nullSlot; }
+
+    bool operator==(const PopulationHandle&) const = default;
+};
+
+template <size_t N>
+class BasicPopulationView;
+
+template <size_t N>
+class BasicPopulationRef;
+
+// Populations of one island stored column by column, so kernels and snapshots scanning one trait read dense memory.
+// Resource use is a row-major matrix with one row of getNumberOfNiches() values per population, with a compile-time
+// number of niches the row width is a constant and row copies and scans unroll.
+// Rows are kept dense by moving the last row into the place of a removed one, so their order is not stable. Code that
+// needs to find a population again later holds a PopulationHandle, which a small slot table maps to the current row.
+template <size_t N>
+class BasicPopulationStore {
+private:
+    size_t numNiches;                            // Width of a resource use row (equal to N unless N is dynamic)
+    std::vector<PopulationId> ids;               // Unique population ids
+    std::vector<int> locationIds;                // Island ids
+    std::vector<PopulationId> parentIds;         // Parent population ids (noParent if none)
+    std::vector<double> mutationRates;           // Intrinsic mutation rates
+    std::vector<double> mobilities;              // Mobility rates
+    std::vector<double> reproductivities;        // Reproduction rates
+    std::vector<double> resourceUse;             // Per capita resource use, one row per population
+    std::vector<int> rateSlots;                  // Slots in the event rate store (-1 until registered there)
+    std::vector<uint32_t> handleSlots;           // Handle slot of each row
+
+    // Handle table, slots are recycled and their generation is bumped on every removal
+    std::vector<uint32_t> slotRows;              // Current row of the population in each slot
+    std::vector<uint32_t> slotGenerations;       // Current generation of each slot
+    std::vector<uint32_t> freeHandleSlots;       // Slots not in use
+
+    IdIndex rowsById;                            // Current row of each population id
+
+    friend class BasicPopulationView<N>;
+    friend class BasicPopulationRef<N>;
+
+    // Width of a resource use row, a constant unless N is dynamic
+    [[nodiscard]] size_t rowWidth() const {
+        if constexpr (N == dynamicNiches) {
+            return numNiches;
+        } else {
+            return N;
+        }
+    }
+
+    // Give the row just appended a handle slot, reusing a free one if possible
+    void assignHandleSlot() {
+        uint32_t slot;
+        if (!freeHandleSlots.empty()) {
+            slot = freeHandleSlots.back();
+            freeHandleSlots.pop_back();
+        } else {
+            slot = static_cast<uint32_t>(slotRows.size());
+            slotRows.push_back(0);
+            slotGenerations.push_back(0);
+        }
+        slotRows[slot] = static_cast<uint32_t>(ids.size() - 1);
+        handleSlots.push_back(slot);
+        rowsById.insert(ids.back(), ids.size() - 1);
+    }
+
+public:
+    static constexpr PopulationId noParent = -1;
+    static constexpr size_t npos = static_cast<size_t>(-1);
+
+    // Forward iterator handing out views, so a store can be walked like the vector of populations it replaces
+    class const_iterator {
+    private:
+        const BasicPopulationStore* store;
+        size_t index;
+
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = BasicPopulationView<N>;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = BasicPopulationView<N>;
+
+        const_iterator(const BasicPopulationStore* populations, size_t position) : store(populations), index(position) {}
+
+        BasicPopulationView<N> operator*() const { return {*store, index}; }
+
+        const_iterator& operator++() {
+            ++index;
+            return *this;
+        }
+
+        const_iterator operator++(int) {
+            const_iterator previous = *this;
+            ++index;
+            return previous;
+        }
+
+        bool operator==(const const_iterator& other) const { return index == other.index; }
+    };
+
+    // Constructor, a fixed number of niches must match the niche dimensions of the island
+    explicit BasicPopulationStore(size_t nicheDimensions) : numNiches(nicheDimensions) {
+        if (N != dynamicNiches && nicheDimensions != N) {
+            throw std::invalid_argument("Expected " + std::to_string(N) + " niche dimensions");
+        }
+    }
+
+    // Make room for a number of populations, so adding and removing while at most that many live never allocates
+    void reserve(size_t numPopulations) {
+        ids.reserve(numPopulations);
+        locationIds.reserve(numPopulations);
+        parentIds.reserve(numPopulations);
+        mutationRates.reserve(numPopulations);
+        mobilities.reserve(numPopulations);
+        reproductivities.reserve(numPopulations);
+        resourceUse.reserve(numPopulations * rowWidth());
+        rateSlots.reserve(numPopulations);
+        handleSlots.reserve(numPopulations);
+        slotRows.reserve(numPopulations);
+        slotGenerations.reserve(numPopulations);
+        freeHandleSlots.reserve(numPopulations);
+        rowsById.reserve(numPopulations);
+    }
+
+    // Append a population, its resource use is cut or zero-padded to the width of the store, returns its handle
+    PopulationHandle add(const BasicUnitPopulation<N>& population) {
+        ids.push_back(population.getId());
+        locationIds.push_back(population.getLocationId());
+        parentIds.push_back(population.getParentUnitId().value_or(noParent));
+        mutationRates.push_back(population.getMutationRate());
+        mobilities.push_back(population.getMobility());
+        reproductivities.push_back(population.getReproductivity());
+        rateSlots.push_back(-1);
+
+        const auto& resources = population.getResourceUsePerNiche();
+        for (size_t niche = 0; niche < rowWidth(); ++niche) {
+            resourceUse.push_back(niche < resources.size() ? resources[niche] : 0.0);
+        }
+        assignHandleSlot();
+        return getHandle(ids.size() - 1);
+    }
+
+    // Append a copy of a population of some store (possibly this one) as its child, returns the child's index
+    size_t addClone(const BasicPopulationStore& source, size_t sourceIndex, PopulationId id, int locationId) {
+        ids.push_back(id);
+        locationIds.push_back(locationId);
+        parentIds.push_back(source.ids[sourceIndex]);
+        mutationRates.push_back(source.mutationRates[sourceIndex]);
+        mobilities.push_back(source.mobilities[sourceIndex]);
+        reproductivities.push_back(source.reproductivities[sourceIndex]);
+        rateSlots.push_back(-1);
+
+        // Grow first and copy by index, the source row may live in the vector being grown
+        size_t row = resourceUse.size();
+        size_t width = std::min(rowWidth(), source.rowWidth());
+        resourceUse.resize(row + rowWidth(), 0.0);
+        for (size_t niche = 0; niche < width; ++niche) {
+            resourceUse[row + niche] = source.resourceUse[sourceIndex * source.rowWidth() + niche];
+        }
+        assignHandleSlot();
+        return ids.size() - 1;
+    }
+
+    // Remove the population at an index by moving the last row into its place, its handle goes stale
+    void remove(size_t index) {
+        uint32_t removedSlot = handleSlots[index];
+        ++slotGenerations[removedSlot];
+        freeHandleSlots.push_back(removedSlot);
+        rowsById.erase(ids[index]);
+
+        size_t last = ids.size() - 1;
+        if (index != last) {
+            ids[index] = ids[last];
+            locationIds[index] = locationIds[last];
+            parentIds[index] = parentIds[last];
+            mutationRates[index] = mutationRates[last];
+            mobilities[index] = mobilities[last];
+            reproductivities[index] = reproductivities[last];
+            rateSlots[index] = rateSlots[last];
+            handleSlots[index] = handleSlots[last];
+            std::copy_n(resourceUse.begin() + static_cast<std::ptrdiff_t>(last * rowWidth()), rowWidth(),
+                        resourceUse.begin() + static_cast<std::ptrdiff_t>(index * rowWidth()));
+            slotRows[handleSlots[index]] = static_cast<uint32_t>(index);
+            rowsById.insert(ids[index], index);
+        }
+
+        ids.pop_back();
+        locationIds.pop_back();
+        parentIds.pop_back();
+        mutationRates.pop_back();
+        mobilities.pop_back();
+        reproductivities.pop_back();
+        rateSlots.pop_back();
+        handleSlots.pop_back();
+        resourceUse.resize(last * rowWidth());
+    }
+
+    // Remove the population a handle points to, returns false if the handle is stale
+    bool remove(PopulationHandle handle) {
+        size_t index = indexOf(handle);
+        if (index == npos) {
+            return false;
+        }
+        remove(index);
+        return true;
+    }
+
+    // Get the handle of the population at an index
+    [[nodiscard]] PopulationHandle getHandle(size_t index) const {
+        return {handleSlots[index], slotGenerations[handleSlots[index]]};
+    }
+
+    // Whether a handle still points to a population in this store
+    [[nodiscard]] bool contains(PopulationHandle handle) const {
+        return handle.slot < slotGenerations.size() && slotGenerations[handle.slot] == handle.generation;
+    }
+
+    // Get the current index of the population a handle points to, npos if the handle is stale
+    [[nodiscard]] size_t indexOf(PopulationHandle handle) const {
+        return contains(handle) ? slotRows[handle.slot] : npos;
+    }
+
+    // Find the index of a population by its id, npos if it is not in the store
+    [[nodiscard]] size_t find(PopulationId populationId) const {
+        return rowsById.find(populationId);
+    }
+
+    [[nodiscard]] size_t size() const {
+        return ids.size();
+    }
+
+    [[nodiscard]] bool empty() const {
+        return ids.empty();
+    }
+
+    [[nodiscard]] size_t getNumberOfNiches() const {
+        return rowWidth();
+    }
+
+    [[nodiscard]] BasicPopulationView<N> operator[](size_t index) const {
+        return {*this, index};
+    }
+
+    [[nodiscard]] BasicPopulationRef<N> at(size_t index) {
+        return {*this, index};
+    }
+
+    [[nodiscard]] const_iterator begin() const {
+        return {this, 0};
+    }
+
+    [[nodiscard]] const_iterator end() const {
+        return {this, ids.size()};
+    }
+
+    // Dense columns
+    [[nodiscard]] std::span<const PopulationId> getIds() const { return ids; }
+    [[nodiscard]] std::span<const int> getLocationIds() const { return locationIds; }
+    [[nodiscard]] std::span<const PopulationId> getParentIds() const { return parentIds; }
+    [[nodiscard]] std::span<const double> getMutationRates() const { return mutationRates; }
+    [[nodiscard]] std::span<const double> getMobilities() const { return mobilities; }
+    [[nodiscard]] std::span<const double> getReproductivities() const { return reproductivities; }
+    [[nodiscard]] std::span<const double> getResourceUse() const { return resourceUse; }
+    [[nodiscard]] std::span<const int> getRateSlots() const { return rateSlots; }
+
+    // Record the slot the event rate store gave a population
+    void setRateSlot(size_t index, int slot) {
+        rateSlots[index] = slot;
+    }
+
+    // Resource use row of one population
+    [[nodiscard]] std::span<const double> getResourceUse(size_t index) const {
+        return std::span<const double>(resourceUse).subspan(index * rowWidth(), rowWidth());
+    }
+};
+
+// Read-only view of one population in a store, offers the getters of UnitPopulation
+template <size_t N>
+class BasicPopulationView {
+private:
+    const BasicPopulationStore<N>* store;
+    size_t index;
+
+public:
+    BasicPopulationView(const BasicPopulationStore<N>& populations, size_t position) : store(&populations), index(position) {}
+
+    // Getters
+    [[nodiscard]] PopulationId getId() const { return store->ids[index]; }
+    [[nodiscard]] int getLocationId() const { return store->locationIds[index]; }
+    [[nodiscard]] double getMutationRate() const { return store->mutationRates[index]; }
+    [[nodiscard]] double getMobility() const { return store->mobilities[index]; }
+    [[nodiscard]] std::span<const double> getResourceUsePerNiche() const { return store->getResourceUse(index); }
+    [[nodiscard]] double getReproductivity() const { return store->reproductivities[index]; }
+
+    [[nodiscard]] std::optional<PopulationId> getParentUnitId() const {
+        PopulationId parentId = store->parentIds[index];
+        return parentId == BasicPopulationStore<N>::noParent ? std::nullopt : std::optional<PopulationId>(parentId);
+    }
+
+    // Position of the population within its store
+    [[nodiscard]] size_t getIndex() const { return index; }
+
+    // Copy the population out of the store
+    [[nodiscard]] BasicUnitPopulation<N> toUnitPopulation() const {
+        return {getId(), getLocationId(), getParentUnitId(), getMutationRate(), getMobility(), getResourceUsePerNiche(),
+                getReproductivity()};
+    }
+
+    void printDetails() const {
+        std::optional<PopulationId> parentId = getParentUnitId();
+        std::cout << "UnitPopulation ID: " << getId() << ", Location ID: " << getLocationId()
+                  << ", Parent Unit ID: " << (parentId ? std::to_string(*parentId) : "None")
+                  << ", Mutation Rate: " << getMutationRate() << ", Mobility: " << getMobility()
+                  << ", Reproductivity: " << getReproductivity() << std::endl;
+    }
+};
+
+// Mutable view of one population in a store, offers the getters and setters of UnitPopulation
+template <size_t N>
+class BasicPopulationRef {
+private:
+    BasicPopulationStore<N>* store;
+    size_t index;
+
+public:
+    BasicPopulationRef(BasicPopulationStore<N>& populations, size_t position) : store(&populations), index(position) {}
+
+    // Getters
+    [[nodiscard]] PopulationId getId() const { return store->ids[index]; }
+    [[nodiscard]] int getLocationId() const { return store->locationIds[index]; }
+    [[nodiscard]] double getMutationRate() const { return store->mutationRates[index]; }
+    [[nodiscard]] double getMobility() const { return store->mobilities[index]; }
+    [[nodiscard]] std::span<const double> getResourceUsePerNiche() const { return store->getResourceUse(index); }
+    [[nodiscard]] double getReproductivity() const { return store->reproductivities[index]; }
+
+    // Setters
+    void setMutationRate(double newRate) { store->mutationRates[index] = newRate; }
+    void setMobility(double newMobility) { store->mobilities[index] = newMobility; }
+    void setReproductivity(double newReproductionRate) { store->reproductivities[index] = newReproductionRate; }
+
+    void setResourceUse(size_t niche, double resourceUse) {
+        if (niche < store->rowWidth()) {
+            store->resourceUse[index * store->rowWidth() + niche] = resourceUse;
+        }
+    }
+};
+
+// Population containers with the number of niche dimensions the simulation is compiled for
+using PopulationStore = BasicPopulationStore<nicheDimensions>;
+using PopulationView = BasicPopulationView<nicheDimensions>;
+using PopulationRef = BasicPopulationRef<nicheDimensions>;
+
+
+#endif //FUSION_POPULATION_STORE_H
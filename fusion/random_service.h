@@ -0,0 +1,188 @@
+//
+// Created by Tianjian Qin on 10/16/2026.
+// Class definitions for the random service, counter-based Philox streams keyed by seed, replicate and stream id
+//
+
+#ifndef FUSION_RANDOM_SERVICE_H
+#define FUSION_RANDOM_SERVICE_H
+
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+// Philox4x32-10 (Salmon et al. 2011), maps a 128-bit counter and a 64-bit key to 128 random bits
+inline std::array<uint32_t, 4> philox4x32(std::array<uint32_t, 4> counter, std::array<uint32_t, 2> key) {
+    constexpr uint32_t multiplier0 = 0xD2511F53u;
+    constexpr uint32_t multiplier1 = 0xCD9E8D57u;
+    constexpr uint32_t weyl0 = 0x9E3779B9u;
+    constexpr uint32_t weyl1 = 0xBB67AE85u;
+
+    for (int round = 0; round < 10; ++round) {
+        uint64_t product0 = static_cast<uint64_t>(multiplier0) * counter[0];
+        uint64_t product1 = static_cast<uint64_t>(multiplier1) * counter[2];
+        counter = {static_cast<uint32_t>(product1 >> 32) ^ counter[1] ^ key[0], static_cast<uint32_t>(product1),
+                   static_cast<uint32_t>(product0 >> 32) ^ counter[3] ^ key[1], static_cast<uint32_t>(product0)};
+        key[0] += weyl0;
+        key[1] += weyl1;
+    }
+    return counter;
+}
+
+// A single random stream, the n-th draw is a pure function of (seed, replicate, stream id, n) so streams never depend
+// on which thread runs them or on what other streams did. Usable as a standard uniform random bit generator.
+class RandomStream {
+private:
+    std::array<uint32_t, 2> key;                 // The seed
+    uint32_t replicate;                          // Upper counter words, identify the stream
+    uint32_t streamId;
+    uint64_t position = 0;                       // Lower counter words, index of the next block
+    std::array<uint32_t, 4> block{};             // Output of the current block
+    size_t used = 4;                             // Words of the current block already handed out
+
+    void nextBlock() {
+        block = philox4x32({static_cast<uint32_t>(position), static_cast<uint32_t>(position >> 32), streamId, replicate}, key);
+        ++position;
+        used = 0;
+    }
+
+public:
+    using result_type = uint32_t;
+
+    RandomStream(uint64_t seed, uint32_t replicateIndex, uint32_t stream)
+            : key{static_cast<uint32_t>(seed), static_cast<uint32_t>(seed >> 32)},
+              replicate(replicateIndex), streamId(stream) {}
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return std::numeric_limits<uint32_t>::max(); }
+
+    // Next 32 random bits
+    result_type operator()() {
+        if (used == 4) {
+            nextBlock();
+        }
+        return block[used++];
+    }
+
+    // Next 64 random bits
+    uint64_t next64() {
+        uint64_t high = (*this)();
+        return (high << 32) | (*this)();
+    }
+
+    // Fill a buffer with the same values as repeated next64 calls. Whole blocks are written straight from the counter
+    // instead of word by word, a value straddles two blocks when an odd number of 32-bit words was drawn before.
+    void fill64(uint64_t* out, size_t count) {
+        size_t i = 0;
+        while (i < count && used < 3) {
+            out[i++] = next64();
+        }
+        bool straddling = used == 3;
+        while (count - i >= 2) {
+            uint64_t carry = block[3];
+            nextBlock();
+            if (straddling) {
+                out[i] = (carry << 32) | block[0];
+                out[i + 1] = (static_cast<uint64_t>(block[1]) << 32) | block[2];
+                used = 3;
+            } else {
+                out[i] = (static_cast<uint64_t>(block[0]) << 32) | block[1];
+                out[i + 1] = (static_cast<uint64_t>(block[2]) << 32) | block[3];
+                used = 4;
+            }
+            i += 2;
+        }
+        while (i < count) {
+            out[i++] = next64();
+        }
+    }
+
+    // Map 64 random bits to a uniform double in (0, 1]
+    static double toUniform(uint64_t bits) {
+        return static_cast<double>((bits >> 11) + 1) * 0x1.0p-53;
+    }
+
+    // Map 64 random bits to a uniform integer in [0, bound) (Lemire's multiply-shift, bias below 2^-32 for our sizes)
+    static size_t toIndex(uint64_t bits, size_t bound) {
+        return static_cast<size_t>((static_cast<unsigned __int128>(bits) * bound) >> 64);
+    }
+
+    // Uniform double in (0, 1], never zero so it is safe to take the logarithm of
+    double uniform() {
+        return toUniform(next64());
+    }
+
+    // Exponentially distributed double with the given rate
+    double exponential(double rate) {
+        return -std::log(uniform()) / rate;
+    }
+
+    // Uniform integer in [0, bound), bound must be positive
+    size_t uniformIndex(size_t bound) {
+        return toIndex(next64(), bound);
+    }
+
+    // Fill a buffer with uniform doubles in (0, 1], the same values as repeated uniform calls
+    void fillUniform(double* out, size_t count) {
+        uint64_t bits[64];
+        for (size_t done = 0; done < count; done += 64) {
+            size_t chunk = std::min<size_t>(64, count - done);
+            fill64(bits, chunk);
+            for (size_t i = 0; i < chunk; ++i) {
+                out[done + i] = toUniform(bits[i]);
+            }
+        }
+    }
+
+    // Fill a buffer with exponentially distributed doubles of the given rate, equal to repeated exponential calls
+    void fillExponential(double* out, size_t count, double rate) {
+        fillUniform(out, count);
+        for (size_t i = 0; i < count; ++i) {
+            out[i] = -std::log(out[i]) / rate;
+        }
+    }
+
+    // Jump to an absolute block of the stream, e.g. to replay from a known point
+    void seek(uint64_t blockIndex) {
+        position = blockIndex;
+        used = 4;
+    }
+};
+
+// Hands out the streams of one replicate of a run
+class RandomService {
+private:
+    uint64_t seed;
+    uint32_t replicate;
+
+public:
+    RandomService(uint64_t runSeed, uint32_t replicateIndex = 0) : seed(runSeed), replicate(replicateIndex) {}
+
+    // Get a fresh stream, asking twice for the same id gives identical streams
+    [[nodiscard]] RandomStream stream(uint32_t streamId) const {
+        return {seed, replicate, streamId};
+    }
+
+    [[nodiscard]] uint64_t getSeed() const {
+        return seed;
+    }
+
+    [[nodiscard]] uint32_t getReplicate() const {
+        return replicate;
+    }
+};
+
+// Stream ids used by the simulation
+enum RandomStreamId : uint32_t {
+    SelectionStream = 0,                         // Waiting times and event selection
+    EventStream = 1,                             // Choices made while executing events (mutations, destinations)
+    LeapStream = 2,                              // Event counts and picks of the tau-leaping mode
+    FiringTimeStream = 3,                        // Firing times of the next reaction method
+    IslandStreamBase = 16                        // Island i of the parallel engines draws from IslandStreamBase + i
+};
+
+
+#endif //FUSION_RANDOM_SERVICE_H
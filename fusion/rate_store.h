@@ -0,0 +1,299 @@
+//
+// Created by Tianjian Qin on 10/16/2026.
+// Class definition for the event rate store, which keeps every possible event and its rate up to date incrementally
+//
+
+#ifndef FUSION_RATE_STORE_H
+#define FUSION_RATE_STORE_H
+
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "unit_population.h"
+#include "isolation.h"
+#include "system.h"
+#include "event_selector.h"
+
+// Kind of event a descriptor stands for
+enum class EventKind : uint8_t {
+    Birth,
+    Death,
+    Immigration,
+    ResourceChange,
+    BarrierChange
+};
+
+// A single possible event as a flat record, the objects acting on the system are only built when it fires
+struct EventDescriptor {
+    EventKind kind;
+    int populationSlot;                 // Slot of the population in the rate store (-1 for isolation events)
+    int sourceIsolation;                // Island on which the event takes place
+    int targetIsolation;                // Fixed destination island of the event (-1 if none or drawn on execution)
+    double rate;                        // Current rate of the event
+};
+
+// A population known to the rate store and the positions of its descriptors, slots are recycled
+struct PopulationSlot {
+    PopulationId populationId;          // Id of the population (-1 while the slot is free)
+    int isolation;                      // Island the population lives on
+    PopulationHandle handle;            // Handle of the population in its island's store
+    size_t islandPosition;              // Position of the slot in its island's slot list
+    size_t birth;
+    size_t death;
+    size_t immigration;                 // Lumped emigration towards all other islands
+};
+
+class EventRateStore {
+private:
+    System& system;                                     // The system whose events are stored
+    double baseBirthRate;                               // Rate of birth events (and base of immigration rates)
+    double baseDeathRate;                               // Rate of death events
+    std::vector<EventDescriptor> descriptors;           // All currently possible events, kept dense
+    std::vector<PopulationSlot> populationSlots;        // Populations with their descriptor positions
+    std::vector<int> freeSlots;                         // Slots of populations that left, reused first
+    std::vector<std::vector<int>> islandSlots;          // Per isolation, slots of the populations living on it
+    std::vector<std::vector<double>> resourceTargets;   // Per isolation, availability set by its resource change event
+    std::vector<double> barrierTargets;                 // Per isolation, threshold set by its barrier change event
+    std::unique_ptr<EventSelector> selector;            // Sampling engine mirroring the descriptor rates
+
+    // Append a descriptor and return its position
+    size_t pushDescriptor(const EventDescriptor& descriptor) {
+        selector->add(descriptor.rate, descriptor.sourceIsolation);
+        descriptors.push_back(descriptor);
+        return descriptors.size() - 1;
+    }
+
+    // Remove the descriptor at a position by moving the last descriptor into its place
+    void removeDescriptor(size_t position) {
+        selector->remove(position);
+        size_t last = descriptors.size() - 1;
+        if (position != last) {
+            descriptors[position] = descriptors[last];
+            relocate(descriptors[position], position);
+        }
+        descriptors.pop_back();
+    }
+
+    // Point the bookkeeping of a moved descriptor to its new position
+    void relocate(const EventDescriptor& descriptor, size_t position) {
+        if (descriptor.populationSlot < 0) {
+            return;     // Isolation events are never looked up by position
+        }
+        PopulationSlot& slot = populationSlots[descriptor.populationSlot];
+        switch (descriptor.kind) {
+            case EventKind::Birth:
+                slot.birth = position;
+                break;
+            case EventKind::Death:
+                slot.death = position;
+                break;
+            case EventKind::Immigration:
+                slot.immigration = position;
+                break;
+            default:
+                break;
+        }
+    }
+
+    // Change the rate of a descriptor
+    void setRate(size_t position, double rate) {
+        descriptors[position].rate = rate;
+        selector->update(position, rate);
+    }
+
+    // Rate at which a population on an island emigrates to any other island
+    double emigrationRate(int isolationIndex) {
+        return baseBirthRate * system.getEmigrationWeight(isolationIndex);
+    }
+
+public:
+    // Isolation events of the model (just examples), shared with the parallel engines
+    static constexpr double resourceChangeRate = 0.1;      // Assuming a small probability for resource change
+    static constexpr double barrierChangeRate = 0.05;      // Assuming a smaller chance for barrier change
+    static constexpr double resourceTarget = 10.0;         // Availability of every niche after a resource change
+    static constexpr double barrierTarget = 0.5;           // Threshold to every other island after a barrier change
+
+    // Constructor
+    EventRateStore(System& sys, double birthRate, double deathRate, std::unique_ptr<EventSelector> eventSelector)
+            : system(sys), baseBirthRate(birthRate), baseDeathRate(deathRate), selector(std::move(eventSelector)) {}
+
+    // Build all descriptors from scratch, only needed once before the simulation starts
+    void rebuild() {
+        descriptors.clear();
+        populationSlots.clear();
+        freeSlots.clear();
+        selector->clear();
+
+        int numIsolations = static_cast<int>(system.getNumberOfIsolations());
+        resourceTargets.clear();
+        islandSlots.assign(numIsolations, {});
+        barrierTargets.assign(numIsolations, barrierTarget);
+        for (int isolationIndex = 0; isolationIndex < numIsolations; ++isolationIndex) {
+            size_t numNiches = system.getIsolation(isolationIndex)->getNicheSpaces().getNumberOfDimensions();
+            resourceTargets.emplace_back(numNiches, resourceTarget);
+            const PopulationStore& populations = system.getIsolation(isolationIndex)->getUnitPopulations();
+            for (size_t i = 0; i < populations.size(); ++i) {
+                addPopulation(isolationIndex, populations.getHandle(i));
+            }
+
+            // Isolation resource change event (as an example)
+            pushDescriptor({EventKind::ResourceChange, -1, isolationIndex, -1, resourceChangeRate});
+
+            // Barrier threshold change event
+            pushDescriptor({EventKind::BarrierChange, -1, isolationIndex, -1, barrierChangeRate});
+        }
+    }
+
+    // Make room for a number of living populations, each of which may end up on any island, so adding and removing
+    // populations within that number never allocates. Call after rebuild(), which starts over.
+    void reserve(size_t numPopulations) {
+        size_t numDescriptors = 3 * numPopulations + 2 * system.getNumberOfIsolations();
+        descriptors.reserve(numDescriptors);
+        selector->reserve(numDescriptors);
+        populationSlots.reserve(numPopulations);
+        freeSlots.reserve(numPopulations);
+        for (std::vector<int>& slots : islandSlots) {
+            slots.reserve(numPopulations);
+        }
+    }
+
+    // Add the birth, death and emigration descriptors of a population that appeared on an island, returns its slot
+    int addPopulation(int isolationIndex, PopulationHandle handle) {
+        PopulationStore& populations = system.getIsolation(isolationIndex)->getPopulationStore();
+        size_t index = populations.indexOf(handle);
+        if (index == PopulationStore::npos) {
+            throw std::invalid_argument("Stale population handle for isolation " + std::to_string(isolationIndex));
+        }
+
+        int slotIndex;
+        if (!freeSlots.empty()) {
+            slotIndex = freeSlots.back();
+            freeSlots.pop_back();
+        } else {
+            slotIndex = static_cast<int>(populationSlots.size());
+            populationSlots.emplace_back();
+        }
+
+        PopulationSlot& slot = populationSlots[slotIndex];
+        slot.populationId = populations[index].getId();
+        slot.isolation = isolationIndex;
+        slot.handle = handle;
+        slot.islandPosition = islandSlots[isolationIndex].size();
+        islandSlots[isolationIndex].push_back(slotIndex);
+        slot.birth = pushDescriptor({EventKind::Birth, slotIndex, isolationIndex, -1, baseBirthRate});
+        slot.death = pushDescriptor({EventKind::Death, slotIndex, isolationIndex, -1, baseDeathRate});
+
+        // One emigration event towards all other islands, its destination is drawn from the alias table of the
+        // island's barrier row when it fires (zero while every barrier is closed)
+        slot.immigration = pushDescriptor({EventKind::Immigration, slotIndex, isolationIndex, -1, emigrationRate(isolationIndex)});
+
+        // Let the island know, so rates computed over its population columns can be written back by slot
+        populations.setRateSlot(index, slotIndex);
+        return slotIndex;
+    }
+
+    // Drop every descriptor of a population that left the system and free its slot
+    void removePopulation(int slotIndex) {
+        PopulationSlot& slot = populationSlots[slotIndex];
+        if (slot.populationId < 0) {
+            return;
+        }
+
+        // Remove from the back so earlier positions stay valid
+        std::array<size_t, 3> positions{slot.birth, slot.death, slot.immigration};
+        std::sort(positions.rbegin(), positions.rend());
+        for (size_t position : positions) {
+            removeDescriptor(position);
+        }
+
+        // Move the last slot of the island into the freed place of its list
+        std::vector<int>& slots = islandSlots[slot.isolation];
+        int moved = slots.back();
+        slots[slot.islandPosition] = moved;
+        populationSlots[moved].islandPosition = slot.islandPosition;
+        slots.pop_back();
+
+        populationSlots[slotIndex].populationId = -1;
+        freeSlots.push_back(slotIndex);
+    }
+
+    // Update the emigration descriptors of every population on an island after its barrier row changed
+    void refreshEmigration(int isolationIndex) {
+        double rate = emigrationRate(isolationIndex);
+        for (int slotIndex : islandSlots[isolationIndex]) {
+            setRate(populationSlots[slotIndex].immigration, rate);
+        }
+    }
+
+    // Update the emigration descriptors on both sides of the barrier between two islands
+    void refreshBarrier(int isolationA, int isolationB) {
+        refreshEmigration(isolationA);
+        refreshEmigration(isolationB);
+    }
+
+    // Update the emigration descriptors after the barriers of one island changed, on the islands whose rows changed
+    void refreshIsolationBarriers(const std::vector<int>& changedIsolations) {
+        for (int isolationIndex : changedIsolations) {
+            refreshEmigration(isolationIndex);
+        }
+    }
+
+    // Set the birth and death rates of all populations on an island, given in the order of its population columns
+    void setPopulationRates(int isolationIndex, std::span<const double> birthRates, std::span<const double> deathRates) {
+        std::span<const int> slots = system.getIsolation(isolationIndex)->getUnitPopulations().getRateSlots();
+        for (size_t i = 0; i < slots.size(); ++i) {
+            if (slots[i] >= 0) {
+                setRate(populationSlots[slots[i]].birth, birthRates[i]);
+                setRate(populationSlots[slots[i]].death, deathRates[i]);
+            }
+        }
+    }
+
+    // Get all descriptors
+    [[nodiscard]] const std::vector<EventDescriptor>& getDescriptors() const {
+        return descriptors;
+    }
+
+    // Get all population slots, free slots have a negative population id
+    [[nodiscard]] const std::vector<PopulationSlot>& getPopulationSlots() const {
+        return populationSlots;
+    }
+
+    // Get the id of the population in a slot
+    [[nodiscard]] PopulationId getPopulationId(int slotIndex) const {
+        return populationSlots[slotIndex].populationId;
+    }
+
+    // Get the handle of the population in a slot
+    [[nodiscard]] PopulationHandle getPopulationHandle(int slotIndex) const {
+        return populationSlots[slotIndex].handle;
+    }
+
+    // Get the availability the resource change event of an isolation sets
+    [[nodiscard]] const std::vector<double>& getResourceTarget(int isolationIndex) const {
+        return resourceTargets[isolationIndex];
+    }
+
+    // Get the threshold the barrier change event of an isolation sets
+    [[nodiscard]] double getBarrierTarget(int isolationIndex) const {
+        return barrierTargets[isolationIndex];
+    }
+
+    // Get the sampling engine
+    [[nodiscard]] EventSelector& getSelector() {
+        return *selector;
+    }
+
+    [[nodiscard]] size_t size() const {
+        return descriptors.size();
+    }
+};
+
+
+#endif //FUSION_RATE_STORE_H
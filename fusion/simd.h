@@ -0,0 +1,82 @@
+//
+// Created by Tianjian Qin on 10/16/2026.
+// Definitions shared by the vectorized kernels: instruction set detection and aligned storage
+//
+
+#ifndef FUSION_SIMD_H
+#define FUSION_SIMD_H
+
+
+#include <cstddef>
+#include <new>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define FUSION_X86_SIMD 1
+#include <immintrin.h>
+#else
+#define FUSION_X86_SIMD 0
+#endif
+
+// Instruction sets the kernels can run on
+enum class SimdLevel {
+    Scalar,
+    AVX2,
+    AVX512
+};
+
+// Best instruction set the running CPU supports
+inline SimdLevel detectSimdLevel() {
+#if FUSION_X86_SIMD
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) {
+        return SimdLevel::AVX512;
+    }
+    if (__builtin_cpu_supports("avx2")) {
+        return SimdLevel::AVX2;
+    }
+#endif
+    return SimdLevel::Scalar;
+}
+
+// Name of an instruction set for reporting
+inline const char* simdLevelName(SimdLevel level) {
+    switch (level) {
+        case SimdLevel::AVX512:
+            return "AVX-512";
+        case SimdLevel::AVX2:
+            return "AVX2";
+        case SimdLevel::Scalar:
+            return "Scalar";
+    }
+    return "Unknown";
+}
+
+// Allocator handing out cache-line aligned blocks, for containers that vector loads walk through
+template <typename T, size_t Alignment = 64>
+struct AlignedAllocator {
+    using value_type = T;
+
+    template <typename U>
+    struct rebind {
+        using other = AlignedAllocator<U, Alignment>;
+    };
+
+    AlignedAllocator() = default;
+
+    template <typename U>
+    AlignedAllocator(const AlignedAllocator<U, Alignment>&) {}
+
+    T* allocate(size_t count) {
+        return static_cast<T*>(::operator new(count * sizeof(T), std::align_val_t(Alignment)));
+    }
+
+    void deallocate(T* pointer, size_t) {
+        ::operator delete(pointer, std::align_val_t(Alignment));
+    }
+
+    template <typename U>
+    bool operator==(const AlignedAllocator<U, Alignment>&) const { return true; }
+};
+
+
+#endif //FUSION_SIMD_H
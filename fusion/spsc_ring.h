@@ -0,0 +1,76 @@
+//
+// Created by Tianjian Qin on 10/16/2026.
+// Class definition for a lock-free single-producer single-consumer ring buffer of fixed capacity
+//
+
+#ifndef FUSION_SPSC_RING_H
+#define FUSION_SPSC_RING_H
+
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <vector>
+
+// Bounded queue between exactly one producer and one consumer thread. Both sides own one index and only read the
+// other's, so a push or pop is a plain store plus a release; each side also caches the last index it saw of the other
+// to touch the shared cache line only when the ring looks full or empty. The capacity is rounded up to a power of two.
+template <typename T>
+class SpscRing {
+private:
+    std::vector<T> slots;
+    size_t mask;                                 // Capacity - 1, to wrap indices
+
+    alignas(64) std::atomic<size_t> tail{0};     // Next slot to write, owned by the producer
+    size_t cachedHead = 0;                       // Producer's last view of the head
+    alignas(64) std::atomic<size_t> head{0};     // Next slot to read, owned by the consumer
+    size_t cachedTail = 0;                       // Consumer's last view of the tail
+
+public:
+    explicit SpscRing(size_t capacity)
+            : slots(std::bit_ceil(std::max<size_t>(capacity, 2))), mask(slots.size() - 1) {}
+
+    SpscRing(const SpscRing&) = delete;
+    SpscRing& operator=(const SpscRing&) = delete;
+
+    // Append an item unless the ring is full, only callable from the producer thread
+    bool push(const T& item) {
+        size_t position = tail.load(std::memory_order_relaxed);
+        if (position - cachedHead == slots.size()) {
+            cachedHead = head.load(std::memory_order_acquire);
+            if (position - cachedHead == slots.size()) {
+                return false;
+            }
+        }
+        slots[position & mask] = item;
+        tail.store(position + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Take the oldest item, only callable from the consumer thread
+    bool pop(T& item) {
+        size_t position = head.load(std::memory_order_relaxed);
+        if (position == cachedTail) {
+            cachedTail = tail.load(std::memory_order_acquire);
+            if (position == cachedTail) {
+                return false;
+            }
+        }
+        item = slots[position & mask];
+        head.store(position + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Get the number of items waiting, exact on the producer side up to pops running concurrently
+    [[nodiscard]] size_t size() const {
+        return tail.load(std::memory_order_acquire) - head.load(std::memory_order_acquire);
+    }
+
+    [[nodiscard]] size_t capacity() const {
+        return slots.size();
+    }
+};
+
+
+#endif //FUSION_SPSC_RING_H
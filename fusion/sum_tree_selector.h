@@ -0,0 +1,114 @@
+//
+// Created by Tianjian Qin on 10/16/2026.
+// Class definition for the sum tree selector, a binary tree of partial rate sums for logarithmic event selection
+//
+
+#ifndef FUSION_SUM_TREE_SELECTOR_H
+#define FUSION_SUM_TREE_SELECTOR_H
+
+
+#include <algorithm>
+#include <vector>
+#include "event_selector.h"
+
+// Sum tree selector, leaves hold the rates and every inner node the sum of its two children
+class SumTreeSelector : public EventSelector {
+private:
+    std::vector<double> tree{0.0, 0.0};          // Node i has children 2i and 2i+1, leaves start at capacity
+    size_t capacity = 1;                         // Number of leaves, always a power of two
+    size_t count = 0;                            // Number of leaves in use
+
+    // Recompute the sums on the path from a leaf to the root, recomputing rather than adding deltas avoids drift
+    void propagate(size_t node) {
+        for (node /= 2; node >= 1; node /= 2) {
+            tree[node] = tree[2 * node] + tree[2 * node + 1];
+        }
+    }
+
+    // Double the number of leaves and rebuild the inner nodes
+    void grow() {
+        std::vector<double> leaves(tree.begin() + static_cast<long>(capacity), tree.begin() + static_cast<long>(capacity + count));
+        capacity *= 2;
+        tree.assign(2 * capacity, 0.0);
+        std::copy(leaves.begin(), leaves.end(), tree.begin() + static_cast<long>(capacity));
+        for (size_t node = capacity - 1; node >= 1; --node) {
+            tree[node] = tree[2 * node] + tree[2 * node + 1];
+        }
+    }
+
+public:
+    void clear() override {
+        tree.assign(2, 0.0);
+        capacity = 1;
+        count = 0;
+    }
+
+    void add(double rate, int) override {
+        if (count == capacity) {
+            grow();
+        }
+        tree[capacity + count] = rate;
+        propagate(capacity + count);
+        ++count;
+    }
+
+    void reserve(size_t numEntries) override {
+        while (capacity < numEntries) {
+            grow();
+        }
+    }
+
+    void update(size_t index, double rate) override {
+        tree[capacity + index] = rate;
+        propagate(capacity + index);
+    }
+
+    void remove(size_t index) override {
+        size_t last = count - 1;
+        if (index != last) {
+            update(index, tree[capacity + last]);
+        }
+        update(last, 0.0);
+        --count;
+    }
+
+    [[nodiscard]] double getTotalRate() const override {
+        return tree[1];
+    }
+
+    std::pair<double, size_t> sampleNext(RandomStream& random) override {
+        double totalRate = getTotalRate();
+        if (totalRate <= 0.0) {
+            return {std::numeric_limits<double>::infinity(), npos}; // Nothing can happen anymore
+        }
+
+        // Sample the waiting time for the next event (exponentially distributed)
+        double waitingTime = random.exponential(totalRate);
+
+        // Sample which event happens (based on their relative rates)
+        return {waitingTime, find(random.uniform() * totalRate)};
+    }
+
+    // Find the entry where the cumulative rate passes a threshold in [0, total rate]
+    [[nodiscard]] size_t find(double threshold) const {
+        // Walk down the tree, going right whenever the threshold exceeds the left subtree
+        size_t node = 1;
+        while (node < capacity) {
+            size_t left = 2 * node;
+            if (threshold < tree[left] || tree[left + 1] <= 0.0) {
+                node = left;
+            } else {
+                threshold -= tree[left];
+                node = left + 1;
+            }
+        }
+        return node - capacity;
+    }
+
+    [[nodiscard]] size_t size() const {
+        return count;
+    }
+};
+
+
+#endif //FUSION_SUM_TREE_SELECTOR_H
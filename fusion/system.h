@@ -13,28 +13,66 @@
 #include <random>
 #include "unit_population.h"
 #include "isolation.h"
+#include "alias_table.h"
+#include "barrier_graph.h"
 
 class System {
 private:
     double baseBirthRate;                                   // Base birth rate for populations
     double baseDeathRate;                                   // Base death rate for populations
     std::vector<std::shared_ptr<Isolation>> isolations;     // List of isolations in the system
-    std::vector<std::vector<double>> barrierThresholds;     // Matrix to store barrier thresholds between isolations
-    int nextPopulationId;                                   // Counter to generate unique population IDs
+    BarrierGraph barrierThresholds;                         // Barrier thresholds between isolations, pairs below 1 only when large
+    PopulationIdAllocator populationIds;                    // Hands out unique population ids
+    std::vector<AliasTable> emigrationTables;               // Per source isolation, destinations weighted by 1 - barrier
+    std::vector<std::vector<int>> emigrationTargets;        // Per source isolation, destination of every table column (sparse graphs)
+    std::vector<bool> emigrationTableStale;                 // Per source isolation, whether its row changed since the build
+    std::vector<double> emigrationTotals;                   // Per source isolation, sum of 1 - barrier over all destinations
+    std::vector<bool> emigrationTotalStale;                 // Per source isolation, whether its row changed since the sum
+    std::vector<double> emigrationWeights;                  // Scratch row of weights for table rebuilds
+    std::vector<int> changedIsolations;                     // Isolations whose row the last barrier change touched
+    static inline bool verbose = true;                      // Whether systems and events report every step on stdout
+
+    // Rebuild the emigration table of a source isolation from its row of barrier thresholds. Dense graphs get a column
+    // per isolation (weights computed over the whole row at once), sparse ones a column per neighbour, so a rebuild
+    // only costs as much as the row holds.
+    void rebuildEmigrationTable(int isolation) {
+        std::vector<int>& targets = emigrationTargets[isolation];
+        targets.clear();
+        if (barrierThresholds.isDense()) {
+            const BarrierMatrix& matrix = barrierThresholds.getMatrix();
+            emigrationWeights.resize(matrix.getPaddedSize());
+            matrix.emigrationWeights(isolation, emigrationWeights);
+            emigrationWeights.resize(isolations.size());
+        } else {
+            emigrationWeights.clear();
+            barrierThresholds.forEachNeighbor(isolation, [&](int target, double threshold) {
+                emigrationWeights.push_back(1.0 - threshold);
+                targets.push_back(target);
+            });
+        }
+        emigrationTables[isolation].build(emigrationWeights);
+        emigrationTableStale[isolation] = false;
+    }
 
 public:
     // Constructor to initialize the system with a set number of isolations and barrier thresholds
     System(int numIsolations, double baseBirth, double baseDeath)
-            : baseBirthRate(baseBirth), baseDeathRate(baseDeath), nextPopulationId(0) {
+            : baseBirthRate(baseBirth), baseDeathRate(baseDeath) {
 
-        // Initialize isolations with some default resources (assuming 3 niche dimensions for simplicity)
+        // Initialize isolations with some default resources (3 niche dimensions unless compiled for another number)
+        size_t numNiches = nicheDimensions == dynamicNiches ? 3 : nicheDimensions;
         for (int i = 0; i < numIsolations; ++i) {
-            std::vector<double> initialResources = {10.0, 10.0, 10.0};  // Example initial resource availability
-            isolations.push_back(std::make_shared<Isolation>(initialResources));
+            std::vector<std::pair<double, double>> initialNiches(numNiches, {0.0, 10.0});  // Example initial resource availability
+            isolations.push_back(std::make_shared<Isolation>(i, initialNiches));
         }
 
-        // Initialize the barrier thresholds matrix (default barrier = 1.0 for all pairs)
-        barrierThresholds.resize(numIsolations, std::vector<double>(numIsolations, 1.0));
+        // Initialize the barrier thresholds (default barrier = 1.0 for all pairs)
+        barrierThresholds = BarrierGraph(numIsolations);
+        emigrationTables.resize(numIsolations);
+        emigrationTargets.resize(numIsolations);
+        emigrationTotals.resize(numIsolations, 0.0);
+        emigrationTotalStale.resize(numIsolations, true);
+        emigrationTableStale.resize(numIsolations, true);
 
         // Spawn one unit population in the first isolation
         spawnInitialPopulation();
@@ -43,7 +81,18 @@ public:
     // Destructor
     ~System() {
         isolations.clear();
-        std::cout << "System destroyed, all isolations and populations cleared.\n";
+        if (verbose) {
+            std::cout << "System destroyed, all isolations and populations cleared.\n";
+        }
+    }
+
+    // Switch the step by step reports of all systems and events on or off, not meant to be flipped while running
+    static void setVerbose(bool isVerbose) {
+        verbose = isVerbose;
+    }
+
+    [[nodiscard]] static bool isVerbose() {
+        return verbose;
     }
 
     // Getters
@@ -73,12 +122,62 @@ public:
         return isolations.size();
     }
 
-    [[nodiscard]] const std::vector<std::vector<double>>& getBarrierThresholds() const {
+    [[nodiscard]] const BarrierGraph& getBarrierThresholds() const {
         return barrierThresholds;
     }
 
-    [[nodiscard]] int getNextPopulationId() const {
-        return nextPopulationId;
+    // Choose the instruction set of the emigration weight kernels, scalar by default so seeded runs do not depend on the
+    // CPU. Vector levels are faster on large dense systems but round row sums differently.
+    void setBarrierSimdLevel(SimdLevel level) {
+        barrierThresholds.setSimdLevel(level);
+        std::fill(emigrationTotalStale.begin(), emigrationTotalStale.end(), true);
+    }
+
+    [[nodiscard]] double getBarrierThreshold(int isolationA, int isolationB) const {
+        return barrierThresholds.get(isolationA, isolationB);
+    }
+
+    // Get the alias table of destinations for emigrants from an isolation, rebuilt only if its row changed
+    const AliasTable& getEmigrationTable(int isolation) {
+        if (emigrationTableStale[isolation]) {
+            rebuildEmigrationTable(isolation);
+        }
+        return emigrationTables[isolation];
+    }
+
+    // Draw the destination of an emigrant, with probability proportional to 1 - barrier
+    int sampleEmigrationTarget(int isolation, RandomStream& random) {
+        int column = getEmigrationTable(isolation).sample(random);
+        return barrierThresholds.isDense() ? column : emigrationTargets[isolation][column];
+    }
+
+    // Get the sum of 1 - barrier over all destinations of an isolation, emigration happens at birth rate times this.
+    // Kept apart from the table, so rates can follow barrier changes without rebuilding tables nobody samples from.
+    double getEmigrationWeight(int isolation) {
+        if (emigrationTotalStale[isolation]) {
+            emigrationTotals[isolation] = barrierThresholds.getEmigrationWeight(isolation);
+            emigrationTotalStale[isolation] = false;
+        }
+        return emigrationTotals[isolation];
+    }
+
+    [[nodiscard]] PopulationId getNextPopulationId() const {
+        return populationIds.peek();
+    }
+
+    // Hand out a fresh unique population id
+    PopulationId allocatePopulationId() {
+        return populationIds.allocate();
+    }
+
+    // Reserve a block of unique population ids, for workers allocating on their own
+    PopulationIdBlock reservePopulationIds(PopulationId count) {
+        return populationIds.reserve(count);
+    }
+
+    // Get the allocator handing out population ids, e.g. to give a worker its own cursor over reserved blocks
+    [[nodiscard]] PopulationIdAllocator& getPopulationIdAllocator() {
+        return populationIds;
     }
 
     // Setters
@@ -92,28 +191,67 @@ public:
 
     // Method to spawn the initial unit population in the first isolation
     void spawnInitialPopulation() {
-        std::vector<double> resourceUse = {1.0, 1.0, 1.0};  // Default resource usage for all dimensions
+        // Default resource usage for all dimensions
+        std::vector<double> resourceUse(isolations[0]->getNicheSpaces().getNumberOfDimensions(), 1.0);
         double mutationRate = 0.01;
         double mobility = 0.1;
         double reproductivity = 0.5;
 
-        UnitPopulation initialPopulation(nextPopulationId++, 0, std::nullopt, mutationRate, mobility, resourceUse, reproductivity);
+        UnitPopulation initialPopulation(populationIds.allocate(), 0, std::nullopt, mutationRate, mobility, resourceUse, reproductivity);
         isolations[0]->addUnitPopulation(initialPopulation);
 
-        std::cout << "Initial population spawned in the first isolation.\n";
+        if (verbose) {
+            std::cout << "Initial population spawned in the first isolation.\n";
+        }
     }
 
     // Method to set barrier thresholds between isolations
     void setBarrierThreshold(int isolationA, int isolationB, double threshold) {
         if (isolationA >= 0 && isolationA < isolations.size() && isolationB >= 0 && isolationB < isolations.size()) {
-            barrierThresholds[isolationA][isolationB] = threshold;
-            barrierThresholds[isolationB][isolationA] = threshold;  // Symmetric barrier between A and B
-            std::cout << "Barrier threshold set between Isolation " << isolationA
-                      << " and Isolation " << isolationB << ": " << threshold << "\n";
+            barrierThresholds.set(isolationA, isolationB, threshold);  // Symmetric barrier between A and B
+            emigrationTableStale[isolationA] = true;
+            emigrationTableStale[isolationB] = true;
+            emigrationTotalStale[isolationA] = true;
+            emigrationTotalStale[isolationB] = true;
+            if (verbose) {
+                std::cout << "Barrier threshold set between Isolation " << isolationA
+                          << " and Isolation " << isolationB << ": " << threshold << "\n";
+            }
         } else {
             std::cerr << "Invalid isolation indices provided.\n";
         }
     }
+
+    // Set the barrier between an isolation and each of its neighbours: every other isolation in a dense system, the
+    // isolations it is already connected to in a sparse one. Pairs a large system walls off stay walled off, so barrier
+    // changes never add edges to a sparse graph and cost as much as the isolation's row holds. Returns the isolations
+    // whose rows changed, the isolation itself first.
+    const std::vector<int>& setIsolationBarriers(int isolation, double threshold) {
+        changedIsolations.assign(1, isolation);
+        if (barrierThresholds.isDense()) {
+            for (int other = 0; other < static_cast<int>(isolations.size()); ++other) {
+                if (other != isolation) {
+                    changedIsolations.push_back(other);
+                }
+            }
+        } else {
+            barrierThresholds.forEachNeighbor(isolation, [this](int target, double) {
+                changedIsolations.push_back(target);
+            });
+        }
+        for (size_t i = 1; i < changedIsolations.size(); ++i) {
+            barrierThresholds.set(isolation, changedIsolations[i], threshold);
+        }
+        for (int changed : changedIsolations) {
+            emigrationTableStale[changed] = true;
+            emigrationTotalStale[changed] = true;
+        }
+        if (verbose) {
+            std::cout << "Barrier threshold set between Isolation " << isolation << " and "
+                      << changedIsolations.size() - 1 << " others: " << threshold << "\n";
+        }
+        return changedIsolations;
+    }
 };
 
 
@@ -0,0 +1,68 @@
+//
+// Created by Tianjian Qin on 10/16/2026.
+// Definitions for the approximate tau-leaping mode, including the adaptive leap size selection
+//
+
+#ifndef FUSION_TAU_LEAPING_H
+#define FUSION_TAU_LEAPING_H
+
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <vector>
+#include "system.h"
+
+// Settings of the tau-leaping mode
+struct TauLeapSettings {
+    double epsilon = 0.03;                  // Accuracy tolerance, bound on the relative change of any island per leap
+    size_t criticalPopulationSize = 10;     // Islands with fewer (but some) populations force exact steps
+    size_t exactStepsPerFallback = 100;     // Number of exact steps taken before trying to leap again
+    double minLeapInEvents = 10.0;          // Leaps expected to hold fewer events than this are not worth it
+};
+
+// What the tau-leaping mode did
+struct TauLeapStatistics {
+    size_t leaps = 0;                       // Number of leaps taken
+    size_t leapedEvents = 0;                // Number of events fired inside leaps
+    size_t exactSteps = 0;                  // Number of exact one-event steps taken
+};
+
+// Leap size after Cao, Gillespie and Petzold (2006), bounding the expected change and its variance of the number
+// of populations on every island by max(epsilon * count, 1). Births and deaths change the own island, an immigration
+// adds to the target island only.
+inline double selectTauLeapSize(const System& system, const std::vector<size_t>& populationCounts,
+                                double birthRate, double deathRate, double epsilon) {
+    int numIsolations = static_cast<int>(populationCounts.size());
+    double tau = std::numeric_limits<double>::infinity();
+
+    for (int i = 0; i < numIsolations; ++i) {
+        double count = static_cast<double>(populationCounts[i]);
+        double mean = (birthRate - deathRate) * count;
+        double variance = (birthRate + deathRate) * count;
+
+        // Immigration from every other island into this one, barriers are symmetric so the neighbours of the island
+        // are exactly the islands sending to it
+        system.getBarrierThresholds().forEachNeighbor(i, [&](int source, double barrier) {
+            if (populationCounts[source] > 0) {
+                double inflow = birthRate * (1.0 - barrier) * static_cast<double>(populationCounts[source]);
+                mean += inflow;
+                variance += inflow;
+            }
+        });
+
+        double bound = std::max(epsilon * count, 1.0);
+        if (mean != 0.0) {
+            tau = std::min(tau, bound / std::abs(mean));
+        }
+        if (variance > 0.0) {
+            tau = std::min(tau, bound * bound / variance);
+        }
+    }
+
+    return tau;
+}
+
+
+#endif //FUSION_TAU_LEAPING_H
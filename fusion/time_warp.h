@@ -0,0 +1,169 @@
+//
+// Created by Tianjian Qin on 10/16/2026.
+// Class definition for the Time Warp engine, which simulates the islands of one system in parallel and synchronizes
+// them optimistically
+//
+
+#ifndef FUSION_TIME_WARP_H
+#define FUSION_TIME_WARP_H
+
+
+#include <algorithm>
+#include <atomic>
+#include <barrier>
+#include <chrono>
+#include <cstdint>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include "island_engine.h"
+
+// Tuning of the Time Warp engine
+struct TimeWarpSettings {
+    size_t numThreads = std::thread::hardware_concurrency(); // Number of worker threads, at most one per island
+    double window = 1.0;                    // Simulated time workers may run ahead of the GVT
+    size_t checkpointInterval = 16;         // Steps of an island between two saved states
+    PopulationId idBlockSize = 4096;        // Ids an island reserves at a time
+};
+
+// Statistics of a Time Warp run
+struct TimeWarpStatistics {
+    size_t numThreads = 0;                  // Number of worker threads used
+    size_t windows = 0;                     // Number of GVT advances
+    size_t rounds = 0;                      // Number of synchronization rounds, windows plus retries with messages in flight
+    uint64_t committedSteps = 0;            // Events and messages handled for good
+    uint64_t rolledBackSteps = 0;           // Events and messages handled speculatively and undone
+    uint64_t rollbacks = 0;                 // Number of rollbacks
+    uint64_t antiMessages = 0;              // Number of messages cancelled
+    double wallSeconds = 0.0;               // Wall-clock time of the run
+};
+
+// Every island is a logical process owned by one worker thread. Workers run their islands ahead optimistically within
+// a window past the global virtual time (GVT), immigrations and barrier changes travel as timestamped messages through
+// lock-free inboxes. A message arriving in the past of its island rolls the island back to a saved state and cancels
+// what it sent since with anti-messages. Once no worker has anything left before the window's end and no message is
+// in flight, the GVT moves to the end of the window and everything before it is final.
+// Results only depend on the seed, not on the number of threads or their timing. They are not those of the exact
+// engine with the same seed, as islands draw from their own streams (and with base rates only, like tau-leaping).
+class TimeWarpEngine : private IslandEngine {
+private:
+    TimeWarpSettings settings;
+
+    // Run the islands of a worker until none of them has anything left before the end of the window
+    void runUntilIdle(size_t worker, double windowEnd) {
+        while (true) {
+            drain(worker);
+
+            // Step the island furthest behind, it is the least likely to be rolled back
+            IslandProcess* next = nullptr;
+            double nextTime = windowEnd;
+            for (int island : islandsOfWorker[worker]) {
+                double time = processes[island]->nextTime();
+                if (time < nextTime) {
+                    nextTime = time;
+                    next = processes[island].get();
+                }
+            }
+            if (next == nullptr) {
+                return;
+            }
+            next->step();
+            flush(*next);
+        }
+    }
+
+public:
+    // Constructor
+    TimeWarpEngine(System& sys, Observer& obs, const RandomService& randomService, double birthRate, double deathRate,
+                   const TimeWarpSettings& engineSettings = {})
+            : IslandEngine(sys, obs, randomService, birthRate, deathRate, engineSettings.idBlockSize),
+              settings(engineSettings) {}
+
+    // Simulate the system up to a time, afterwards the system holds the final state and the observer the history
+    TimeWarpStatistics run(double maxTime) {
+        TimeWarpStatistics statistics;
+        auto start = std::chrono::steady_clock::now();
+        bool wasVerbose = System::isVerbose();
+        System::setVerbose(false);
+
+        // Islands continue from the current state of the system
+        size_t numWorkers = startProcesses(settings.numThreads, std::max<size_t>(settings.checkpointInterval, 1));
+        statistics.numThreads = numWorkers;
+
+        // Shared round state, only written by the barrier's completion step while every worker waits
+        double windowEnd = std::min(settings.window, maxTime);
+        double gvt = 0.0;
+        bool windowClosed = false;
+        bool finished = maxTime <= 0.0;
+        std::atomic<bool> failed{false};
+        std::exception_ptr failure;
+        std::mutex failureMutex;
+
+        auto completeRound = [&]() noexcept {
+            ++statistics.rounds;
+            windowClosed = inFlight.load(std::memory_order_relaxed) == 0;
+            if (failed.load(std::memory_order_relaxed)) {
+                finished = true;
+            } else if (windowClosed) {
+                ++statistics.windows;
+                gvt = windowEnd;
+                finished = gvt >= maxTime;
+                windowEnd = std::min(gvt + settings.window, maxTime);
+            }
+        };
+        std::barrier sync(static_cast<std::ptrdiff_t>(numWorkers), completeRound);
+
+        auto work = [&](size_t worker) {
+            while (!finished) {
+                try {
+                    if (!failed.load(std::memory_order_relaxed)) {
+                        runUntilIdle(worker, windowEnd);
+                    }
+                } catch (...) {
+                    std::lock_guard<std::mutex> lock(failureMutex);
+                    if (!failure) {
+                        failure = std::current_exception();
+                    }
+                    failed.store(true, std::memory_order_relaxed);
+                }
+                sync.arrive_and_wait();
+
+                if (windowClosed && !finished) {
+                    for (int island : islandsOfWorker[worker]) {
+                        processes[island]->collectFossils(gvt);
+                        processes[island]->saveCheckpoint();
+                    }
+                }
+            }
+        };
+
+        std::vector<std::thread> workers;
+        for (size_t worker = 1; worker < numWorkers; ++worker) {
+            workers.emplace_back(work, worker);
+        }
+        work(0);
+        for (auto& thread : workers) {
+            thread.join();
+        }
+
+        discardInFlight();
+        if (failure) {
+            System::setVerbose(wasVerbose);
+            std::rethrow_exception(failure);
+        }
+
+        for (const auto& process : processes) {
+            statistics.rolledBackSteps += process->getRolledBackSteps();
+            statistics.rollbacks += process->getRollbacks();
+            statistics.antiMessages += process->getAntiMessages();
+        }
+        statistics.committedSteps = finishProcesses();
+        System::setVerbose(wasVerbose);
+
+        statistics.wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        return statistics;
+    }
+};
+
+
+#endif //FUSION_TIME_WARP_H
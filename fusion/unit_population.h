@@ -9,46 +9,68 @@
 
 
 #include <vector>
+#include <span>
 #include <string>
 #include <optional>
 #include <iostream>
+#include "niche.h"
+#include "population_id.h"
 
-class UnitPopulation {
+template <size_t N>
+class BasicUnitPopulation {
 private:
-    int unitPopulationId;                          // Unique identifier for the unit population
+    PopulationId unitPopulationId;                 // Unique identifier for the unit population
     int locationId;                                // Island id where this population resides
-    std::optional<int> parentUnitId;               // Optional parent unit id (could be none)
+    std::optional<PopulationId> parentUnitId;      // Optional parent unit id (could be none)
     double intrinsicMutationRate;                  // Mutation rate specific to this population
     double mobility;                               // Mobility rate of this population
-    std::vector<double> resourceUsePerNiche;       // List of per capita resource use for all niche dimensions
+    NicheArray<double, N> resourceUsePerNiche{};   // List of per capita resource use for all niche dimensions
     double reproductivity;                         // Reproductivity rate
 
 public:
     // Constructor
-    UnitPopulation(int id, int locId, std::optional<int> parentId, double mutationRate, double mobilityRate,
-                   const std::vector<double>& resources, double reproductionRate)
+    BasicUnitPopulation(PopulationId id, int locId, std::optional<PopulationId> parentId, double mutationRate, double mobilityRate,
+                        std::span<const double> resources, double reproductionRate)
             : unitPopulationId(id), locationId(locId), parentUnitId(parentId), intrinsicMutationRate(mutationRate),
-              mobility(mobilityRate), resourceUsePerNiche(resources), reproductivity(reproductionRate) {}
+              mobility(mobilityRate), reproductivity(reproductionRate) {
+        setResourceUsePerNiche(resources);
+    }
 
     // Destructor
-    ~UnitPopulation() = default;
+    ~BasicUnitPopulation() = default;
+
+    // Copy and move, declared since the destructor above would otherwise suppress moving
+    BasicUnitPopulation(const BasicUnitPopulation&) = default;
+    BasicUnitPopulation(BasicUnitPopulation&&) noexcept = default;
+    BasicUnitPopulation& operator=(const BasicUnitPopulation&) = default;
+    BasicUnitPopulation& operator=(BasicUnitPopulation&&) noexcept = default;
 
     // Getters
-    [[nodiscard]] int getId() const { return unitPopulationId; }
+    [[nodiscard]] PopulationId getId() const { return unitPopulationId; }
     [[nodiscard]] int getLocationId() const { return locationId; }
-    [[nodiscard]] std::optional<int> getParentUnitId() const { return parentUnitId; }
+    [[nodiscard]] std::optional<PopulationId> getParentUnitId() const { return parentUnitId; }
     [[nodiscard]] double getMutationRate() const { return intrinsicMutationRate; }
     [[nodiscard]] double getMobility() const { return mobility; }
-    [[nodiscard]] const std::vector<double>& getResourceUsePerNiche() const { return resourceUsePerNiche; }
+    [[nodiscard]] const NicheArray<double, N>& getResourceUsePerNiche() const { return resourceUsePerNiche; }
     [[nodiscard]] double getReproductivity() const { return reproductivity; }
 
     // Setters
     void setLocationId(int newLocationId) { locationId = newLocationId; }
     void setMutationRate(double newRate) { intrinsicMutationRate = newRate; }
     void setMobility(double newMobility) { mobility = newMobility; }
-    void setResourceUsePerNiche(const std::vector<double>& resources) { resourceUsePerNiche = resources; }
     void setReproductivity(double newReproductionRate) { reproductivity = newReproductionRate; }
 
+    // Set the resource use of every niche, a fixed number of niches takes the leading values and zero-pads the rest
+    void setResourceUsePerNiche(std::span<const double> resources) {
+        if constexpr (N == dynamicNiches) {
+            resourceUsePerNiche.assign(resources.begin(), resources.end());
+        } else {
+            for (size_t i = 0; i < N; ++i) {
+                resourceUsePerNiche[i] = i < resources.size() ? resources[i] : 0.0;
+            }
+        }
+    }
+
     // Utility methods
     void printDetails() const {
         std::cout << "UnitPopulation ID: " << unitPopulationId << ", Location ID: " << locationId
@@ -58,5 +80,8 @@ public:
     }
 };
 
+// Unit population with the number of niche dimensions the simulation is compiled for
+using UnitPopulation = BasicUnitPopulation<nicheDimensions>;
+
 
 #endif //FUSION_UNIT_POPULATION_H
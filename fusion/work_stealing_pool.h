@@ -0,0 +1,115 @@
+//
+// Created by Tianjian Qin on 10/16/2026.
+// Class definition for a work-stealing thread pool, which runs a batch of independent tasks of uneven length
+//
+
+#ifndef FUSION_WORK_STEALING_POOL_H
+#define FUSION_WORK_STEALING_POOL_H
+
+
+#include <atomic>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class WorkStealingPool {
+private:
+    // Task queue of one worker, the owner takes from the back and thieves from the front
+    struct WorkerQueue {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    std::vector<std::unique_ptr<WorkerQueue>> queues;    // One queue per worker
+    size_t nextQueue = 0;                                // Queue receiving the next submitted task
+    std::atomic<size_t> steals{0};                       // Number of tasks taken from another worker's queue
+
+    // Take the most recently submitted task of a worker's own queue
+    bool popLocal(size_t worker, std::function<void()>& task) {
+        WorkerQueue& queue = *queues[worker];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.tasks.empty()) {
+            return false;
+        }
+        task = std::move(queue.tasks.back());
+        queue.tasks.pop_back();
+        return true;
+    }
+
+    // Take the oldest task of some other worker's queue
+    bool steal(size_t thief, std::function<void()>& task) {
+        for (size_t offset = 1; offset < queues.size(); ++offset) {
+            WorkerQueue& queue = *queues[(thief + offset) % queues.size()];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            if (!queue.tasks.empty()) {
+                task = std::move(queue.tasks.front());
+                queue.tasks.pop_front();
+                steals.fetch_add(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+        return false;
+    }
+
+public:
+    // Constructor
+    explicit WorkStealingPool(size_t numThreads = std::thread::hardware_concurrency()) {
+        numThreads = numThreads > 0 ? numThreads : 1;
+        for (size_t i = 0; i < numThreads; ++i) {
+            queues.push_back(std::make_unique<WorkerQueue>());
+        }
+    }
+
+    // Queue a task for the next run, tasks are dealt round robin over the workers
+    void submit(std::function<void()> task) {
+        queues[nextQueue]->tasks.push_back(std::move(task));
+        nextQueue = (nextQueue + 1) % queues.size();
+    }
+
+    // Run all queued tasks and wait for them, the first exception thrown by a task is rethrown afterwards
+    void run() {
+        std::exception_ptr failure;
+        std::mutex failureMutex;
+
+        std::vector<std::thread> workers;
+        for (size_t worker = 0; worker < queues.size(); ++worker) {
+            workers.emplace_back([this, worker, &failure, &failureMutex]() {
+                // Tasks never submit new tasks, so a worker that finds every queue empty is done
+                std::function<void()> task;
+                while (popLocal(worker, task) || steal(worker, task)) {
+                    try {
+                        task();
+                    } catch (...) {
+                        std::lock_guard<std::mutex> lock(failureMutex);
+                        if (!failure) {
+                            failure = std::current_exception();
+                        }
+                    }
+                }
+            });
+        }
+        for (auto& thread : workers) {
+            thread.join();
+        }
+        nextQueue = 0;
+
+        if (failure) {
+            std::rethrow_exception(failure);
+        }
+    }
+
+    [[nodiscard]] size_t getNumberOfThreads() const {
+        return queues.size();
+    }
+
+    [[nodiscard]] size_t getNumberOfSteals() const {
+        return steals.load(std::memory_order_relaxed);
+    }
+};
+
+
+#endif //FUSION_WORK_STEALING_POOL_H